@@ -0,0 +1,19 @@
+#!/bin/sh
+
+# Build the application with 1, 2 and 4 software draw units and run the
+# full-screen UI benchmark (ANC_UI_BENCH) with each build.
+# Needs the same display device access as the application itself.
+#
+# usage: draw_unit_bench.sh [FRAMES] [BUILD_PREFIX]
+
+FRAMES=${1:-300}
+PREFIX=${2:-build_draw}
+SRC_DIR=$(cd "$(dirname "$0")/.." && pwd)
+
+for UNITS in 1 2 4
+do
+    BUILD_DIR="$PREFIX$UNITS"
+    cmake -S "$SRC_DIR" -B "$BUILD_DIR" -DCMAKE_C_FLAGS="-DLV_DRAW_SW_DRAW_UNIT_CNT=$UNITS" > /dev/null || exit 1
+    cmake --build "$BUILD_DIR" -j "$(nproc)" > /dev/null || exit 1
+    ANC_UI_BENCH=$FRAMES "$BUILD_DIR/bin/lvglsim" | grep -A1 "^UI benchmark"
+done
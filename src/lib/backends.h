@@ -69,6 +69,13 @@ typedef struct {
 /* Prototype used to register a backend */
 typedef int (*backend_init_t)(backend_t *);
 
+/* Presentation timing of the frames flipped by the fbdev panning mode,
+ * the DRM backend provides none */
+typedef struct {
+    uint32_t frames;       /* Frames whose flip was observed */
+    uint64_t timestamp_us; /* CLOCK_MONOTONIC time the flip took effect */
+} backend_vblank_t;
+
 /**********************
  * GLOBAL PROTOTYPES
  **********************/
@@ -80,6 +87,10 @@ int backend_init_sdl(backend_t *backend);
 int backend_init_glfw3(backend_t *backend);
 int backend_init_wayland(backend_t *backend);
 int backend_init_x11(backend_t *backend);
+int backend_init_offscreen(backend_t *backend);
+
+/* Presentation timing of the fbdev backend in panning mode */
+int backend_fbdev_get_vblank(backend_vblank_t *vblank);
 
 /* Input device driver backends */
 int backend_init_evdev(backend_t *backend);
@@ -0,0 +1,115 @@
+#include <stdint.h>
+#include <string.h>
+#include "chart_dirty.h"
+
+void chart_dirty_init(chart_dirty * dirty, lv_obj_t * chart, int32_t range_min, int32_t range_max)
+{
+    memset(dirty, 0, sizeof(*dirty));
+    dirty->chart     = chart;
+    dirty->range_min = range_min;
+    dirty->range_max = range_max;
+}
+
+void chart_dirty_begin(chart_dirty * dirty)
+{
+    memset(dirty->band, 0, sizeof(dirty->band));
+    dirty->point_count = lv_chart_get_point_count(dirty->chart);
+}
+
+// 点index变化, 与前后两点相连的线段新旧位置都要重绘, values为这几个点的新旧值
+static void band_add(chart_dirty * dirty, uint32_t index, const int32_t * values, int count)
+{
+    chart_dirty_band * band = &dirty->band[(uint64_t)index * CHART_DIRTY_BANDS / dirty->point_count];
+    uint32_t first          = index > 0 ? index - 1 : 0;
+    uint32_t last           = index + 1 < dirty->point_count ? index + 1 : index;
+
+    if(!band->used) {
+        band->used  = true;
+        band->first = first;
+        band->last  = last;
+        band->y_min = INT32_MAX;
+        band->y_max = INT32_MIN;
+    }
+    if(first < band->first) band->first = first;
+    if(last > band->last) band->last = last;
+
+    // 空点不绘制, 不计入范围
+    for(int i = 0; i < count; i++) {
+        if(values[i] == LV_CHART_POINT_NONE) continue;
+        if(values[i] < band->y_min) band->y_min = values[i];
+        if(values[i] > band->y_max) band->y_max = values[i];
+    }
+}
+
+static inline int32_t value_at(const int32_t * values, uint32_t index)
+{
+    return values != NULL ? values[index] : LV_CHART_POINT_NONE;
+}
+
+void chart_dirty_set_series(chart_dirty * dirty, lv_chart_series_t * series, const int32_t * values, uint32_t count)
+{
+    int32_t * y      = lv_chart_get_series_y_array(dirty->chart, series);
+    uint32_t points  = lv_chart_get_point_count(dirty->chart);
+    int32_t prev_old = LV_CHART_POINT_NONE; // 前一点的旧值, 数组中已被覆盖
+    int32_t prev_new = LV_CHART_POINT_NONE;
+
+    // 点数变化时lv_chart_set_point_count已让整个图表失效, 之前按旧点数记录的分带作废
+    if(points != dirty->point_count) chart_dirty_begin(dirty);
+    if(points == 0) return;
+
+    if(count > points) count = points;
+    for(uint32_t i = 0; i < count; i++) {
+        int32_t old   = y[i];
+        int32_t value = value_at(values, i);
+
+        if(old != value) {
+            int32_t next_old    = i + 1 < points ? y[i + 1] : LV_CHART_POINT_NONE;
+            int32_t next_new    = i + 1 < count ? value_at(values, i + 1) : next_old;
+            int32_t involved[6] = {old, value, prev_old, prev_new, next_old, next_new};
+
+            band_add(dirty, i, involved, 6);
+            y[i] = value;
+        }
+        prev_old = old;
+        prev_new = value;
+    }
+}
+
+void chart_dirty_commit(chart_dirty * dirty)
+{
+    lv_area_t content;
+    lv_area_t areas[CHART_DIRTY_BANDS];
+    int area_count     = 0;
+    int64_t dirty_size = 0;
+
+    lv_obj_get_content_coords(dirty->chart, &content);
+    int32_t w     = lv_area_get_width(&content);
+    int32_t h     = lv_area_get_height(&content);
+    int64_t span  = (int64_t)dirty->range_max - dirty->range_min;
+    uint32_t last = dirty->point_count > 1 ? dirty->point_count - 1 : 1;
+    // 线宽和数据点标记会超出折线本身
+    int32_t pad = lv_obj_get_style_line_width(dirty->chart, LV_PART_ITEMS) +
+                  lv_obj_get_style_width(dirty->chart, LV_PART_INDICATOR) / 2 + 2;
+
+    if(span <= 0) span = 1; // 范围无效时lv_chart同样无法正常绘制, 仅避免除零
+
+    for(int b = 0; b < CHART_DIRTY_BANDS; b++) {
+        const chart_dirty_band * band = &dirty->band[b];
+        if(!band->used || band->y_min > band->y_max) continue;
+
+        // 与lv_chart绘制折线时的坐标换算一致
+        lv_area_t * area = &areas[area_count++];
+        area->x1         = content.x1 + (int32_t)((int64_t)w * band->first / last) - pad;
+        area->x2         = content.x1 + (int32_t)((int64_t)w * band->last / last) + pad;
+        area->y1         = content.y1 + h - (int32_t)(((int64_t)band->y_max - dirty->range_min) * h / span) - pad;
+        area->y2         = content.y1 + h - (int32_t)(((int64_t)band->y_min - dirty->range_min) * h / span) + pad;
+        dirty_size += (int64_t)lv_area_get_width(area) * lv_area_get_height(area);
+    }
+    if(area_count == 0) return;
+
+    if(dirty_size * 100 > (int64_t)w * h * CHART_DIRTY_FULL_PCT) {
+        lv_obj_invalidate(dirty->chart);
+        return;
+    }
+    for(int i = 0; i < area_count; i++) lv_obj_invalidate_area(dirty->chart, &areas[i]);
+}
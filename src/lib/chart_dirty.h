@@ -0,0 +1,39 @@
+#ifndef CHART_DIRTY_H
+#define CHART_DIRTY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "lvgl/lvgl.h"
+
+// 折线图局部刷新: 直接写入曲线数组并与旧值比较, 只让变化线段的包围盒失效
+// 一次更新(begin/set_series.../commit)内所有曲线合并, 每次最多失效CHART_DIRTY_BANDS个矩形
+// 要求曲线只通过本模块或lv_chart_set_series_values整体更新, 不使用lv_chart_set_next_value
+#define CHART_DIRTY_BANDS 12    // X方向分带数, 远小于LVGL失效区域上限(LV_INV_BUF_SIZE)
+#define CHART_DIRTY_FULL_PCT 75 // 失效面积超过内容区此比例时直接整体失效, 省去逐块绘制开销
+
+typedef struct
+{
+    bool used;
+    uint32_t first; // 受影响的点序号范围, 含相邻点
+    uint32_t last;
+    int32_t y_min; // 新旧折线在该带内的取值范围(图表坐标)
+    int32_t y_max;
+} chart_dirty_band;
+
+typedef struct
+{
+    lv_obj_t * chart;
+    int32_t range_min; // 图表主Y轴范围, 用于换算像素
+    int32_t range_max;
+    uint32_t point_count;
+    chart_dirty_band band[CHART_DIRTY_BANDS];
+} chart_dirty;
+
+void chart_dirty_init(chart_dirty * dirty, lv_obj_t * chart, int32_t range_min, int32_t range_max);
+void chart_dirty_begin(chart_dirty * dirty);
+// 写入一条曲线的前count个点并记录变化, count超过图表点数时截断, values为NULL时清空为空点
+void chart_dirty_set_series(chart_dirty * dirty, lv_chart_series_t * series, const int32_t * values, uint32_t count);
+// 按记录的变化失效区域, 没有变化时不触发重绘
+void chart_dirty_commit(chart_dirty * dirty);
+
+#endif // CHART_DIRTY_H
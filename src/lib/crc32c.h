@@ -0,0 +1,19 @@
+#ifndef CRC32C_H
+#define CRC32C_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// CRC-32C (Castagnoli, 反射多项式0x82F63B78), 用于rpmsg v2帧校验
+#define CRC32C_INIT 0xFFFFFFFFu
+#define CRC32C_FINAL(crc) ((crc) ^ 0xFFFFFFFFu)
+
+// 分段累加: crc = crc32c_update(CRC32C_INIT, ...) ... 最后取CRC32C_FINAL(crc)
+uint32_t crc32c_update(uint32_t crc, const void * data, size_t len);
+uint32_t crc32c(const void * data, size_t len);
+
+// 运行期选择实现: SSE4.2 / ARMv8 CRC指令可用时走硬件, 否则slicing-by-8查表
+const char * crc32c_impl(void);
+void crc32c_benchmark(size_t len, int iterations);
+
+#endif // CRC32C_H
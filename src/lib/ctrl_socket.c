@@ -0,0 +1,359 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <stdatomic.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include "linux_msg.h"
+#include "frame_bus.h"
+#include "ctrl_socket.h"
+
+#define CTRL_MAX_CLIENTS 8
+#define CTRL_REPLY_TIMEOUT_MS 100
+#define CTRL_SUB_QUEUE_DEPTH 32 // 每个订阅客户端在帧总线上的队列深度, 容纳两个满通道采样块
+
+typedef struct
+{
+    int fd;
+    frame_sub_t * sub; // 帧总线订阅, NULL表示未订阅
+    uint32_t dropped;  // 发送缓冲区满而丢弃的帧数
+} ctrl_client;
+
+static int listen_fd = -1;
+static char socket_path[sizeof(((struct sockaddr_un *)0)->sun_path)];
+static pthread_t ctrl_thread;
+static atomic_bool ctrl_should_exit = false;
+
+// 客户端表, 只由服务线程访问
+static ctrl_client clients[CTRL_MAX_CLIENTS];
+
+// 协议中的订阅掩码与帧总线掩码取值一致
+typedef char ctrl_sub_mask_matches_bus[(CTRL_SUB_REF == FRAME_MASK_REF && CTRL_SUB_ERR == FRAME_MASK_ERR) ? 1 : -1];
+
+static void client_unsubscribe(ctrl_client * client)
+{
+    frame_bus_unsubscribe(client->sub);
+    client->sub = NULL;
+}
+
+static void client_close(int slot)
+{
+    uint32_t dropped = clients[slot].dropped + (clients[slot].sub ? frame_sub_dropped(clients[slot].sub) : 0);
+
+    if(dropped > 0) printf("Ctrl client %d closed, %u frames dropped\n", slot, dropped);
+    client_unsubscribe(&clients[slot]);
+    close(clients[slot].fd);
+    clients[slot].fd      = -1;
+    clients[slot].dropped = 0;
+}
+
+// 应答必须完整送达, 缓冲区满时短暂等待可写
+static int ctrl_reply(int fd, const ctrl_header * req, uint8_t status, const void * payload, uint16_t length)
+{
+    ctrl_header hdr     = {.magic = CTRL_MAGIC, .op = req->op | CTRL_REPLY, .status = status, .tag = req->tag,
+                           .length = length};
+    struct iovec iov[2] = {{.iov_base = &hdr, .iov_len = sizeof(hdr)}, {.iov_base = (void *)payload, .iov_len = length}};
+    struct msghdr mh    = {.msg_iov = iov, .msg_iovlen = length > 0 ? 2 : 1};
+
+    for(int retry = 0; retry < 2; retry++) {
+        if(sendmsg(fd, &mh, MSG_DONTWAIT | MSG_NOSIGNAL) >= 0) return 0;
+        if(errno != EAGAIN && errno != EWOULDBLOCK) break;
+        struct pollfd pfd = {.fd = fd, .events = POLLOUT};
+        poll(&pfd, 1, CTRL_REPLY_TIMEOUT_MS);
+    }
+    perror("Ctrl reply failed");
+    return -1;
+}
+
+static void handle_request(int slot, const uint8_t * msg, size_t len)
+{
+    ctrl_header req;
+    const uint8_t * payload;
+    int fd = clients[slot].fd;
+
+    if(len < sizeof(ctrl_header)) return;
+    memcpy(&req, msg, sizeof(req));
+    payload = msg + sizeof(req);
+
+    if(req.magic != CTRL_MAGIC) {
+        ctrl_reply(fd, &req, CTRL_ERR_MAGIC, NULL, 0);
+        return;
+    }
+    if(req.length != len - sizeof(req)) {
+        ctrl_reply(fd, &req, CTRL_ERR_LEN, NULL, 0);
+        return;
+    }
+
+    switch(req.op) {
+        case CTRL_OP_CMD: {
+            uint16_t cmd_id;
+            if(req.length != sizeof(cmd_id)) break;
+            memcpy(&cmd_id, payload, sizeof(cmd_id));
+            if(cmd_id > CMD_GET_ARRAY || cmd_id == CMD_SET_PARAM) {
+                ctrl_reply(fd, &req, CTRL_ERR_PARAM, NULL, 0);
+                return;
+            }
+            if(cmd_id == QUIT) {
+                // 退出前先应答, send_msg不会返回
+                ctrl_reply(fd, &req, CTRL_OK, NULL, 0);
+                ctrl_socket_stop();
+                send_msg(QUIT, 0, 0);
+                return;
+            }
+            ctrl_reply(fd, &req, send_msg(cmd_id, 0, 0) == 0 ? CTRL_OK : CTRL_ERR_IO, NULL, 0);
+            return;
+        }
+        case CTRL_OP_SET_PARAM: {
+            ParamPayload param;
+            if(req.length != sizeof(param)) break;
+            memcpy(&param, payload, sizeof(param));
+            ctrl_reply(fd, &req, send_msg(CMD_SET_PARAM, param.param_id, param.param_value) == 0 ? CTRL_OK : CTRL_ERR_IO,
+                       NULL, 0);
+            return;
+        }
+        case CTRL_OP_GET_PARAM: {
+            ParamPayload param;
+            if(req.length != sizeof(param.param_id)) break;
+            memcpy(&param.param_id, payload, sizeof(param.param_id));
+            if(get_param(param.param_id, &param.param_value) != 0) {
+                ctrl_reply(fd, &req, CTRL_ERR_PARAM, NULL, 0);
+                return;
+            }
+            ctrl_reply(fd, &req, CTRL_OK, &param, sizeof(param));
+            return;
+        }
+        case CTRL_OP_SUBSCRIBE: {
+            uint32_t mask;
+            if(req.length != sizeof(mask)) break;
+            memcpy(&mask, payload, sizeof(mask));
+            client_unsubscribe(&clients[slot]);
+            clients[slot].sub = frame_bus_subscribe(mask, CTRL_SUB_QUEUE_DEPTH, FRAME_DROP_OLDEST);
+            ctrl_reply(fd, &req, clients[slot].sub ? CTRL_OK : CTRL_ERR_IO, NULL, 0);
+            return;
+        }
+        case CTRL_OP_UNSUBSCRIBE: {
+            if(req.length != 0) break;
+            client_unsubscribe(&clients[slot]);
+            ctrl_reply(fd, &req, CTRL_OK, NULL, 0);
+            return;
+        }
+        case CTRL_OP_STREAM: {
+            StreamConfig config;
+            if(req.length != 0 && req.length != sizeof(config)) break;
+            if(req.length != 0) {
+                // 新配置在实时端应答MSG_STREAM_CONFIG后生效, 客户端可再次查询确认
+                memcpy(&config, payload, sizeof(config));
+                if(rpmsg_request_stream(config.frame_samples, config.sample_rate) != 0) {
+                    ctrl_reply(fd, &req, CTRL_ERR_PARAM, NULL, 0);
+                    return;
+                }
+            }
+            rpmsg_get_stream(&config);
+            ctrl_reply(fd, &req, CTRL_OK, &config, sizeof(config));
+            return;
+        }
+        case CTRL_OP_INJECT: {
+            ctrl_reply(fd, &req, rpmsg_inject(payload, req.length) == 0 ? CTRL_OK : CTRL_ERR_PARAM, NULL, 0);
+            return;
+        }
+        case CTRL_OP_STATS: {
+            frame_pool_stats pool;
+            rpmsg_rx_stats rx;
+            rpmsg_peer_status peer;
+            ctrl_stats stats;
+            if(req.length != 0) break;
+            frame_bus_pool_stats(&pool);
+            rpmsg_get_rx_stats(&rx);
+            rpmsg_get_peer_status(&peer);
+            stats.pool_capacity       = pool.capacity;
+            stats.pool_in_use         = pool.in_use;
+            stats.pool_peak           = pool.peak;
+            stats.pool_exhausted      = pool.exhausted;
+            stats.rx_frames           = rx.frames;
+            stats.rx_lost             = rx.lost;
+            stats.rx_resyncs          = rx.resyncs;
+            stats.rx_crc_errors       = rx.crc_errors;
+            stats.rt_state            = peer.state;
+            stats.rt_heartbeats       = peer.heartbeats;
+            stats.rt_heartbeat_age_ms = peer.heartbeat_age_ms;
+            stats.rt_errors           = peer.errors;
+            stats.rt_last_error       = peer.last_error;
+            ctrl_reply(fd, &req, CTRL_OK, &stats, sizeof(stats));
+            return;
+        }
+        default: ctrl_reply(fd, &req, CTRL_ERR_OP, NULL, 0); return;
+    }
+
+    // 负载长度与操作不符
+    ctrl_reply(fd, &req, CTRL_ERR_LEN, NULL, 0);
+}
+
+static void accept_client(void)
+{
+    int fd = accept(listen_fd, NULL, NULL);
+    if(fd < 0) {
+        if(errno != EAGAIN && errno != EINTR) perror("Ctrl accept failed");
+        return;
+    }
+    fcntl(fd, F_SETFL, O_NONBLOCK);
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+
+    for(int i = 0; i < CTRL_MAX_CLIENTS; i++) {
+        if(clients[i].fd < 0) {
+            clients[i].fd      = fd;
+            clients[i].sub     = NULL;
+            clients[i].dropped = 0;
+            return;
+        }
+    }
+
+    printf("Ctrl socket: too many clients\n");
+    close(fd);
+}
+
+// 把订阅队列中的帧推送给客户端, 直接引用帧缓冲区, 不复制采样数据
+static void client_flush_frames(ctrl_client * client)
+{
+    frame_t * frame;
+    uint64_t count;
+
+    if(read(frame_sub_fd(client->sub), &count, sizeof(count)) < 0 && errno != EAGAIN) return;
+
+    while((frame = frame_sub_poll(client->sub)) != NULL) {
+        ctrl_header hdr      = {.magic  = CTRL_MAGIC,
+                                .op     = CTRL_EVT_FRAME,
+                                .status = CTRL_OK,
+                                .tag    = 0,
+                                .length = (uint16_t)(sizeof(ctrl_frame_event) + frame->count * sizeof(double))};
+        ctrl_frame_event evt = {.msg_type     = frame->msg_type,
+                                .count        = frame->count,
+                                .seq          = frame->seq,
+                                .dropped      = client->dropped + frame_sub_dropped(client->sub),
+                                .src_seq      = frame->src_seq,
+                                .timestamp_us = frame->timestamp_us,
+                                .channel      = frame->channel};
+        struct iovec iov[3]  = {{.iov_base = &hdr, .iov_len = sizeof(hdr)},
+                                {.iov_base = &evt, .iov_len = sizeof(evt)},
+                                {.iov_base = frame->voltage, .iov_len = frame->count * sizeof(double)}};
+        struct msghdr mh     = {.msg_iov = iov, .msg_iovlen = 3};
+
+        // 慢客户端只丢自己的帧
+        if(sendmsg(client->fd, &mh, MSG_DONTWAIT | MSG_NOSIGNAL) < 0) client->dropped++;
+        frame_release(frame);
+    }
+}
+
+static void * ctrl_thread_func(void * arg)
+{
+    struct pollfd fds[CTRL_MAX_CLIENTS * 2 + 1];
+    int slots[CTRL_MAX_CLIENTS * 2 + 1];
+    static uint8_t msg[sizeof(ctrl_header) + CTRL_MAX_PAYLOAD];
+
+    (void)arg;
+
+    while(!atomic_load(&ctrl_should_exit)) {
+        int nfds = 0;
+
+        fds[nfds].fd     = listen_fd;
+        fds[nfds].events = POLLIN;
+        slots[nfds++]    = -1;
+        for(int i = 0; i < CTRL_MAX_CLIENTS; i++) {
+            if(clients[i].fd < 0) continue;
+            fds[nfds].fd     = clients[i].fd;
+            fds[nfds].events = POLLIN;
+            slots[nfds++]    = i;
+            if(clients[i].sub == NULL) continue;
+            // 订阅队列的eventfd与客户端socket一起等待, 编号取负以示区分
+            fds[nfds].fd     = frame_sub_fd(clients[i].sub);
+            fds[nfds].events = POLLIN;
+            slots[nfds++]    = -2 - i;
+        }
+
+        if(poll(fds, nfds, 500) <= 0) continue;
+
+        for(int i = 1; i < nfds; i++) {
+            if(fds[i].revents == 0) continue;
+
+            if(slots[i] < -1) {
+                int slot = -2 - slots[i];
+                if(clients[slot].sub != NULL) client_flush_frames(&clients[slot]);
+                continue;
+            }
+            if(clients[slots[i]].fd < 0) continue;
+
+            ssize_t n = recv(fds[i].fd, msg, sizeof(msg), MSG_DONTWAIT | MSG_TRUNC);
+            if(n == 0 || (n < 0 && errno != EAGAIN && errno != EINTR)) {
+                client_close(slots[i]);
+            } else if(n > (ssize_t)sizeof(msg)) {
+                ctrl_header req;
+                memcpy(&req, msg, sizeof(req));
+                ctrl_reply(fds[i].fd, &req, CTRL_ERR_LEN, NULL, 0);
+            } else if(n > 0) {
+                handle_request(slots[i], msg, (size_t)n);
+            }
+        }
+
+        if(fds[0].revents & POLLIN) accept_client();
+    }
+
+    return NULL;
+}
+
+int ctrl_socket_start(const char * path)
+{
+    struct sockaddr_un addr = {.sun_family = AF_UNIX};
+
+    if(strlen(path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "Ctrl socket path too long: %s\n", path);
+        return -1;
+    }
+    strcpy(addr.sun_path, path);
+
+    for(int i = 0; i < CTRL_MAX_CLIENTS; i++) {
+        clients[i].fd  = -1;
+        clients[i].sub = NULL;
+    }
+
+    listen_fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if(listen_fd < 0) {
+        perror("Ctrl socket creation failed");
+        return -1;
+    }
+
+    unlink(path); // 清理上次残留的socket文件
+    if(bind(listen_fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 || listen(listen_fd, CTRL_MAX_CLIENTS) < 0) {
+        perror("Ctrl socket bind failed");
+        close(listen_fd);
+        listen_fd = -1;
+        return -1;
+    }
+    strcpy(socket_path, path);
+
+    if(pthread_create(&ctrl_thread, NULL, ctrl_thread_func, NULL)) {
+        perror("Failed to create ctrl thread");
+        close(listen_fd);
+        listen_fd = -1;
+        unlink(socket_path);
+        return -1;
+    }
+
+    printf("Ctrl socket listening on %s\n", socket_path);
+    return 0;
+}
+
+void ctrl_socket_stop(void)
+{
+    if(listen_fd < 0) return;
+
+    atomic_store(&ctrl_should_exit, true);
+    unlink(socket_path);
+}
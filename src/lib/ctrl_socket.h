@@ -0,0 +1,83 @@
+#ifndef CTRL_SOCKET_H
+#define CTRL_SOCKET_H
+
+#include <stdint.h>
+#include "rpmsg_protocol.h"
+
+// 本地控制/遥测接口, 供自动化测试台使用
+// 传输层为UNIX域SOCK_SEQPACKET, 每个报文 = ctrl_header + 负载, 报文边界由内核保证
+#define CTRL_SOCKET_PATH "/tmp/anc_ctrl.sock"
+#define CTRL_MAGIC 0xA5C3
+#define CTRL_MAX_PAYLOAD (sizeof(rpmsg_header_v2) + RPMSG_MAX_PAYLOAD) // 请求负载上限, 注入可容纳任意一条v2消息
+
+typedef enum {
+    CTRL_OP_CMD         = 0x01, // 执行linux_msg.h中的cmd, 负载: uint16_t cmd
+    CTRL_OP_SET_PARAM   = 0x02, // 负载: ParamPayload
+    CTRL_OP_GET_PARAM   = 0x03, // 负载: uint16_t param_id, 应答: ParamPayload
+    CTRL_OP_SUBSCRIBE   = 0x04, // 负载: uint32_t 订阅掩码(ctrl_sub_mask)
+    CTRL_OP_UNSUBSCRIBE = 0x05, // 无负载
+    CTRL_OP_INJECT      = 0x06, // 负载: 原始rpmsg数据包, 测试客户端代替实时核发送数据
+    CTRL_OP_STATS       = 0x07, // 无负载, 应答: ctrl_stats
+    CTRL_OP_STREAM      = 0x08, // 负载: StreamConfig 发起握手, 或无负载仅查询; 应答: 当前StreamConfig
+    CTRL_EVT_FRAME      = 0x40, // 服务端推送: ctrl_frame_event + double[count]
+    CTRL_REPLY          = 0x80  // 应答标志, 应答op = 请求op | CTRL_REPLY
+} ctrl_op;
+
+typedef enum {
+    CTRL_OK        = 0,
+    CTRL_ERR_MAGIC = 1, // 报文头魔数错误
+    CTRL_ERR_OP    = 2, // 未知操作
+    CTRL_ERR_LEN   = 3, // 负载长度与操作不符
+    CTRL_ERR_PARAM = 4, // 命令或参数无效
+    CTRL_ERR_IO    = 5  // 发往实时核失败
+} ctrl_status;
+
+// 订阅掩码 bit n 对应通道n, 多通道帧的其余通道按 1 << n 订阅
+typedef enum {
+    CTRL_SUB_REF = 0x01, // 参考信号帧
+    CTRL_SUB_ERR = 0x02  // 误差信号帧
+} ctrl_sub_mask;
+
+#pragma pack(push, 1)
+typedef struct
+{
+    uint16_t magic;  // CTRL_MAGIC
+    uint8_t op;      // ctrl_op
+    uint8_t status;  // 请求中为0, 应答中为ctrl_status
+    uint16_t tag;    // 客户端自定义, 应答原样带回
+    uint16_t length; // 负载长度
+} ctrl_header;
+
+typedef struct
+{
+    uint16_t msg_type;     // MSG_REF_ARRAY / MSG_ERR_ARRAY / MSG_MULTI_ARRAY
+    uint16_t count;        // 采样点数
+    uint32_t seq;          // 帧总线发布序号(含未订阅类型的帧)
+    uint32_t dropped;      // 本客户端累计丢帧数, 客户端据此发现丢帧
+    uint32_t src_seq;      // 实时端发送序号, v1数据包为0
+    uint64_t timestamp_us; // 采样时刻(CLOCK_MONOTONIC, 微秒)
+    uint16_t channel;      // 通道号
+} ctrl_frame_event;
+
+typedef struct
+{
+    uint32_t pool_capacity;       // 帧缓冲池容量
+    uint32_t pool_in_use;         // 当前占用
+    uint32_t pool_peak;           // 占用峰值
+    uint32_t pool_exhausted;      // 池耗尽丢帧次数
+    uint32_t rx_frames;           // rpmsg成功解码的消息数
+    uint32_t rx_lost;             // 按序号推算的丢失消息数
+    uint32_t rx_resyncs;          // 错位重同步次数
+    uint32_t rx_crc_errors;       // CRC校验失败次数
+    uint32_t rt_state;            // 实时端运行状态(rt_state)
+    uint32_t rt_heartbeats;       // 实时端心跳计数
+    uint32_t rt_heartbeat_age_ms; // 距最近一次心跳的时间, 未收到过为0xFFFFFFFF
+    uint32_t rt_errors;           // 实时端错误上报次数
+    uint32_t rt_last_error;       // 最近一次错误码
+} ctrl_stats;
+#pragma pack(pop)
+
+int ctrl_socket_start(const char * path);
+void ctrl_socket_stop(void);
+
+#endif // CTRL_SOCKET_H
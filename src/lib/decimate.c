@@ -0,0 +1,32 @@
+#include <string.h>
+#include "decimate.h"
+
+uint32_t decimate_m4(const double * in, uint32_t count, uint32_t columns, double * out)
+{
+    uint32_t n = 0;
+
+    if(columns == 0 || count <= columns * DECIMATE_M4_POINTS) {
+        memcpy(out, in, count * sizeof(double));
+        return count;
+    }
+
+    for(uint32_t c = 0; c < columns; c++) {
+        uint32_t a       = (uint32_t)((uint64_t)count * c / columns);
+        uint32_t b       = (uint32_t)((uint64_t)count * (c + 1) / columns);
+        uint32_t min_idx = a;
+        uint32_t max_idx = a;
+
+        for(uint32_t i = a + 1; i < b; i++) {
+            if(in[i] < in[min_idx]) min_idx = i;
+            if(in[i] > in[max_idx]) max_idx = i;
+        }
+
+        // 最值按出现先后排列, 相邻列之间的连线方向才与原始波形一致
+        out[n++] = in[a];
+        out[n++] = in[min_idx < max_idx ? min_idx : max_idx];
+        out[n++] = in[min_idx < max_idx ? max_idx : min_idx];
+        out[n++] = in[b - 1];
+    }
+
+    return n;
+}
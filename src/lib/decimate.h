@@ -0,0 +1,14 @@
+#ifndef DECIMATE_H
+#define DECIMATE_H
+
+#include <stdint.h>
+
+// M4抽取: 每个像素列保留首点、最小值、最大值、末点, 按时间顺序输出
+// 折线图逐像素渲染结果与画全部采样一致, 短时尖峰不会像等间隔抽样那样被漏掉
+#define DECIMATE_M4_POINTS 4 // 每列输出点数
+
+// count <= columns * DECIMATE_M4_POINTS时原样拷贝, 否则输出columns * DECIMATE_M4_POINTS个点
+// 返回输出点数, out至少容纳min(count, columns * DECIMATE_M4_POINTS)个点
+uint32_t decimate_m4(const double * in, uint32_t count, uint32_t columns, double * out);
+
+#endif // DECIMATE_H
@@ -83,6 +83,9 @@ int backend_init_drm(backend_t *backend)
  * Initialize the DRM display driver
  *
  * @return the LVGL display
+ * @description the LVGL DRM driver allocates two dumb scanout buffers,
+ * renders directly into the one not being scanned out and presents it
+ * with an atomic page flip, so no copy is made and no frame tears
  */
 static lv_display_t *init_drm(void)
 {
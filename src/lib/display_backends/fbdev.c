@@ -18,9 +18,15 @@
 #include <unistd.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <string.h>
+#include <fcntl.h>
+#include <time.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
 
 #include "lvgl/lvgl.h"
 #if LV_USE_LINUX_FBDEV
+#include <linux/fb.h>
 #include "../simulator_util.h"
 #include "../backends.h"
 
@@ -28,15 +34,32 @@
  *      DEFINES
  *********************/
 
+/* A pan issued right after a vsync that takes longer than this blocked
+ * until the next one, even a 144 Hz panel has a longer frame period */
+#define PAN_BLOCKING_US 4000
+
 /**********************
  *      TYPEDEFS
  **********************/
 
+/* Framebuffer used as two pages, the displayed one and the one rendered into */
+typedef struct {
+    int fd;
+    struct fb_var_screeninfo vinfo;
+    struct fb_fix_screeninfo finfo;
+    uint8_t *fbp;
+    size_t page_size;
+    bool wait_vsync;    /* The pan returns before the flip takes effect */
+} fbdev_pan_t;
+
 /**********************
  *  STATIC PROTOTYPES
  **********************/
 
 static lv_display_t *init_fbdev(void);
+static lv_display_t *init_fbdev_pan(const char *device);
+static void flush_pan_cb(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map);
+static uint64_t now_us(void);
 static void run_loop_fbdev(void);
 
 /**********************
@@ -45,6 +68,9 @@ static void run_loop_fbdev(void);
 
 static char *backend_name = "FBDEV";
 
+static fbdev_pan_t pan = { .fd = -1 };
+static backend_vblank_t vblank_info;
+
 /**********************
  *      MACROS
  **********************/
@@ -74,6 +100,24 @@ int backend_init_fbdev(backend_t *backend)
     return 0;
 }
 
+/**
+ * Get the presentation timing of the frames shown so far
+ *
+ * @param vblank filled with the flip count and the time of the last flip
+ * @return 0 on success, -1 if the panning mode is not in use
+ * @description the timestamp is taken when the flip has taken effect
+ */
+int backend_fbdev_get_vblank(backend_vblank_t *vblank)
+{
+    if (pan.fd < 0) {
+        return -1;
+    }
+
+    *vblank = vblank_info;
+
+    return 0;
+}
+
 /**********************
  *   STATIC FUNCTIONS
  **********************/
@@ -86,7 +130,16 @@ int backend_init_fbdev(backend_t *backend)
 static lv_display_t *init_fbdev(void)
 {
     const char *device = getenv_default("LV_LINUX_FBDEV_DEVICE", "/dev/fb0");
-    lv_display_t *disp = lv_linux_fbdev_create();
+    lv_display_t *disp;
+
+    if (strcmp(getenv_default("LV_LINUX_FBDEV_PAN", "1"), "0") != 0) {
+        disp = init_fbdev_pan(device);
+        if (disp != NULL) {
+            return disp;
+        }
+    }
+
+    disp = lv_linux_fbdev_create();
 
     if (disp == NULL) {
         return NULL;
@@ -97,6 +150,178 @@ static lv_display_t *init_fbdev(void)
     return disp;
 }
 
+/**
+ * Initialize the panning double buffered mode
+ *
+ * @param device the framebuffer device node
+ * @return the LVGL display or NULL if the framebuffer can't hold two pages
+ * @description LVGL renders in direct mode into the page that is not
+ * displayed, the flush pans to it, so nothing is copied and the visible
+ * page is never written to. LV_LINUX_FBDEV_VSYNC selects whether the
+ * flush waits for vsync after the pan: 1 always, 0 never (the driver's
+ * pan blocks until vsync), auto (default) measures the driver's pan.
+ * A driver that would need the wait but has no FBIO_WAITFORVSYNC can't
+ * flip in sync and gets the copying mode
+ */
+static lv_display_t *init_fbdev_pan(const char *device)
+{
+    lv_display_t *disp;
+    lv_color_format_t cf;
+    const char *vsync = getenv_default("LV_LINUX_FBDEV_VSYNC", "auto");
+    uint32_t crtc = 0;
+    bool vsync_ok;
+    uint64_t pan_us;
+
+    pan.fd = open(device, O_RDWR | O_CLOEXEC);
+    if (pan.fd < 0) {
+        return NULL;
+    }
+
+    if (ioctl(pan.fd, FBIOGET_VSCREENINFO, &pan.vinfo) != 0) {
+        goto fail;
+    }
+
+    /* Ask for a virtual screen twice the visible height if not already set */
+    if (pan.vinfo.yres_virtual < pan.vinfo.yres * 2) {
+        pan.vinfo.yres_virtual = pan.vinfo.yres * 2;
+        if (ioctl(pan.fd, FBIOPUT_VSCREENINFO, &pan.vinfo) != 0 ||
+            ioctl(pan.fd, FBIOGET_VSCREENINFO, &pan.vinfo) != 0 ||
+            pan.vinfo.yres_virtual < pan.vinfo.yres * 2) {
+            LV_LOG_INFO("%s can't hold two pages, using the copying mode", device);
+            goto fail;
+        }
+    }
+
+    if (ioctl(pan.fd, FBIOGET_FSCREENINFO, &pan.finfo) != 0) {
+        goto fail;
+    }
+
+    switch (pan.vinfo.bits_per_pixel) {
+    case 16:
+        cf = LV_COLOR_FORMAT_RGB565;
+        break;
+    case 24:
+        cf = LV_COLOR_FORMAT_RGB888;
+        break;
+    case 32:
+        cf = LV_COLOR_FORMAT_XRGB8888;
+        break;
+    default:
+        goto fail;
+    }
+
+    pan.page_size = (size_t)pan.finfo.line_length * pan.vinfo.yres;
+    if (pan.finfo.smem_len < pan.page_size * 2) {
+        goto fail;
+    }
+
+    pan.fbp = mmap(NULL, pan.page_size * 2, PROT_READ | PROT_WRITE, MAP_SHARED, pan.fd, 0);
+    if (pan.fbp == MAP_FAILED) {
+        pan.fbp = NULL;
+        goto fail;
+    }
+
+    /* Page 0 is normally on screen, show a blank page 1 so that LVGL
+     * renders the first frame into page 0 while it is hidden.
+     * Starting the pan right after a vsync also tells whether the
+     * driver blocks until the flip took effect */
+    memset(pan.fbp + pan.page_size, 0, pan.page_size);
+    vsync_ok = ioctl(pan.fd, FBIO_WAITFORVSYNC, &crtc) == 0;
+    pan.vinfo.xoffset = 0;
+    pan.vinfo.yoffset = pan.vinfo.yres;
+    pan_us = now_us();
+    if (ioctl(pan.fd, FBIOPAN_DISPLAY, &pan.vinfo) != 0) {
+        LV_LOG_INFO("%s can't pan, using the copying mode", device);
+        munmap(pan.fbp, pan.page_size * 2);
+        goto fail;
+    }
+    pan_us = now_us() - pan_us;
+
+    if (strcmp(vsync, "auto") == 0) {
+        pan.wait_vsync = pan_us < PAN_BLOCKING_US;
+    } else {
+        pan.wait_vsync = strcmp(vsync, "0") != 0;
+    }
+
+    /* Without FBIO_WAITFORVSYNC a pan that returns early can't be
+     * synchronized, LVGL would render into the page being scanned out */
+    if (pan.wait_vsync && !vsync_ok) {
+        LV_LOG_WARN("%s: no FBIO_WAITFORVSYNC and the pan doesn't block, using the copying mode", device);
+        munmap(pan.fbp, pan.page_size * 2);
+        goto fail;
+    }
+
+    disp = lv_display_create(pan.vinfo.xres, pan.vinfo.yres);
+    if (disp == NULL) {
+        munmap(pan.fbp, pan.page_size * 2);
+        goto fail;
+    }
+
+    lv_display_set_color_format(disp, cf);
+    lv_display_set_buffers_with_stride(disp, pan.fbp, pan.fbp + pan.page_size, pan.page_size,
+                                       pan.finfo.line_length, LV_DISPLAY_RENDER_MODE_DIRECT);
+    lv_display_set_flush_cb(disp, flush_pan_cb);
+
+    LV_LOG_INFO("%s: %ux%u, %u bpp, panning double buffer, %s", device,
+                pan.vinfo.xres, pan.vinfo.yres, pan.vinfo.bits_per_pixel,
+                pan.wait_vsync ? "waiting for vsync" : "pan blocks until vsync");
+
+    return disp;
+
+fail:
+    close(pan.fd);
+    pan.fd = -1;
+    return NULL;
+}
+
+/**
+ * Flip to the page that was just rendered
+ *
+ * @param disp the display
+ * @param area the area rendered in this flush
+ * @param px_map start of the rendered page in direct mode
+ * @description the pan takes effect at the next vsync, the previous page
+ * must no longer be scanned out before LVGL renders the next frame into
+ * it. Drivers whose pan returns early get an explicit wait, waiting
+ * after a blocking pan would skip a whole frame
+ */
+static void flush_pan_cb(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map)
+{
+    uint32_t crtc = 0;
+
+    LV_UNUSED(area);
+
+    if (!lv_display_flush_is_last(disp)) {
+        lv_display_flush_ready(disp);
+        return;
+    }
+
+    pan.vinfo.xoffset = 0;
+    pan.vinfo.yoffset = px_map == pan.fbp ? 0 : pan.vinfo.yres;
+
+    if (ioctl(pan.fd, FBIOPAN_DISPLAY, &pan.vinfo) != 0) {
+        LV_LOG_WARN("FBIOPAN_DISPLAY failed");
+    } else if (!pan.wait_vsync || ioctl(pan.fd, FBIO_WAITFORVSYNC, &crtc) == 0) {
+        vblank_info.frames++;
+        vblank_info.timestamp_us = now_us();
+    }
+
+    lv_display_flush_ready(disp);
+}
+
+/**
+ * Get the monotonic time
+ *
+ * @return the time in microseconds
+ */
+static uint64_t now_us(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
 /**
  * The run loop of the fbdev driver
  */
@@ -0,0 +1,567 @@
+/**
+ * @file offscreen.c
+ *
+ * Headless backend rendering into a memory buffer
+ *
+ * Needs no display hardware or window system, used to measure the
+ * rendering cost of an application reproducibly, e.g in a container.
+ * Optionally every rendered frame is written to a PPM or PNG file.
+ *
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <unistd.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+
+#include "lvgl/lvgl.h"
+#include "../simulator_util.h"
+#include "../simulator_settings.h"
+#include "../backends.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+
+/* Largest payload of a stored (uncompressed) deflate block */
+#define DEFLATE_STORED_MAX 65535
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+/* Rendering time of the frames since the display was created */
+typedef struct {
+    uint32_t frames;
+    uint64_t total_us;
+    uint64_t worst_us;
+    uint64_t start_us;      /* Start of the frame being rendered */
+    uint64_t created_us;    /* Creation of the display */
+} offscreen_timing_t;
+
+/**********************
+ *  EXTERNAL VARIABLES
+ **********************/
+extern simulator_settings_t settings;
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static lv_display_t *init_offscreen(void);
+static void run_loop_offscreen(void);
+static void render_start_cb(lv_event_t *e);
+static void flush_cb(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map);
+static void print_report(void);
+static bool dump_pattern_valid(const char *pattern);
+static void dump_frame(const uint8_t *px_map);
+static void row_to_rgb(const uint8_t *src, uint8_t *dst);
+static int write_ppm(FILE *f, const uint8_t *px_map);
+static int write_png(FILE *f, const uint8_t *px_map);
+static uint64_t now_us(void);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static char *backend_name = "OFFSCREEN";
+
+static lv_draw_buf_t *frame_buf;
+static lv_color_format_t frame_cf;
+static uint32_t frame_w;
+static uint32_t frame_h;
+
+/* printf pattern of the dump file names, gets the frame number */
+static const char *dump_pattern;
+/* Frames after which the run loop returns, 0 runs forever */
+static uint32_t max_frames;
+
+static offscreen_timing_t timing;
+
+/**********************
+ *      MACROS
+ **********************/
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+/**
+ * Register the backend
+ *
+ * @param backend the backend descriptor
+ * @description configures the descriptor
+ */
+int backend_init_offscreen(backend_t *backend)
+{
+    LV_ASSERT_NULL(backend);
+
+    backend->handle->display = malloc(sizeof(display_backend_t));
+    LV_ASSERT_NULL(backend->handle->display);
+
+    backend->handle->display->init_display = init_offscreen;
+    backend->handle->display->run_loop = run_loop_offscreen;
+    backend->name = backend_name;
+    backend->type = BACKEND_DISPLAY;
+
+    return 0;
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+/**
+ * Initialize the offscreen display
+ *
+ * @return the LVGL display
+ * @description the resolution is the window size of the settings,
+ * the color depth is taken from LV_OFFSCREEN_DEPTH (16, 24 or 32)
+ */
+static lv_display_t *init_offscreen(void)
+{
+    lv_display_t *disp;
+    int depth = atoi(getenv_default("LV_OFFSCREEN_DEPTH", "0"));
+
+    switch (depth) {
+    case 0:
+        frame_cf = LV_COLOR_FORMAT_NATIVE;
+        break;
+    case 16:
+        frame_cf = LV_COLOR_FORMAT_RGB565;
+        break;
+    case 24:
+        frame_cf = LV_COLOR_FORMAT_RGB888;
+        break;
+    case 32:
+        frame_cf = LV_COLOR_FORMAT_XRGB8888;
+        break;
+    default:
+        LV_LOG_ERROR("Unsupported color depth %d, use 16, 24 or 32", depth);
+        return NULL;
+    }
+
+    dump_pattern = getenv("LV_OFFSCREEN_DUMP");
+    if (dump_pattern != NULL && !dump_pattern_valid(dump_pattern)) {
+        LV_LOG_ERROR("LV_OFFSCREEN_DUMP needs exactly one integer conversion, e.g. frame_%%04u.png");
+        return NULL;
+    }
+
+    frame_w = settings.window_width;
+    frame_h = settings.window_height;
+
+    disp = lv_display_create(frame_w, frame_h);
+    if (disp == NULL) {
+        return NULL;
+    }
+
+    lv_display_set_color_format(disp, frame_cf);
+
+    /* A single full frame buffer in direct mode always holds the whole
+     * picture, so a dump needs no composition */
+    frame_buf = lv_draw_buf_create(frame_w, frame_h, frame_cf, LV_STRIDE_AUTO);
+    if (frame_buf == NULL) {
+        lv_display_delete(disp);
+        return NULL;
+    }
+    lv_draw_buf_clear(frame_buf, NULL);
+
+    lv_display_set_draw_buffers(disp, frame_buf, NULL);
+    lv_display_set_render_mode(disp, LV_DISPLAY_RENDER_MODE_DIRECT);
+    lv_display_set_flush_cb(disp, flush_cb);
+    lv_display_add_event_cb(disp, render_start_cb, LV_EVENT_RENDER_START, NULL);
+
+    max_frames = strtoul(getenv_default("LV_OFFSCREEN_FRAMES", "0"), NULL, 10);
+
+    timing.created_us = now_us();
+    atexit(print_report);
+
+    LV_LOG_USER("Offscreen display %ux%u, %u bpp", frame_w, frame_h,
+                lv_color_format_get_bpp(frame_cf));
+
+    return disp;
+}
+
+/**
+ * The run loop of the offscreen driver
+ *
+ * @description returns after LV_OFFSCREEN_FRAMES rendered frames if set
+ */
+static void run_loop_offscreen(void)
+{
+    uint32_t idle_time;
+
+    /* Handle LVGL tasks */
+    while (max_frames == 0 || timing.frames < max_frames) {
+
+        /* Returns the time to the next timer execution */
+        idle_time = lv_timer_handler();
+        usleep(idle_time * 1000);
+    }
+}
+
+/**
+ * Record the start of a frame
+ *
+ * @param e the display event
+ */
+static void render_start_cb(lv_event_t *e)
+{
+    LV_UNUSED(e);
+
+    if (timing.start_us == 0) {
+        timing.start_us = now_us();
+    }
+}
+
+/**
+ * Account the frame and dump it once its last area is rendered
+ *
+ * @param disp the display
+ * @param area the area rendered in this flush
+ * @param px_map start of the frame buffer in direct mode
+ */
+static void flush_cb(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map)
+{
+    uint64_t elapsed;
+
+    LV_UNUSED(area);
+
+    if (!lv_display_flush_is_last(disp)) {
+        lv_display_flush_ready(disp);
+        return;
+    }
+
+    elapsed = now_us() - timing.start_us;
+    timing.start_us = 0;
+    timing.frames++;
+    timing.total_us += elapsed;
+    if (elapsed > timing.worst_us) {
+        timing.worst_us = elapsed;
+    }
+
+    if (dump_pattern != NULL) {
+        dump_frame(px_map);
+    }
+
+    lv_display_flush_ready(disp);
+}
+
+/**
+ * Print the rendering time report
+ */
+static void print_report(void)
+{
+    double seconds = (now_us() - timing.created_us) / 1e6;
+
+    fprintf(stdout, "Offscreen: %u frames, %ux%u, %u bpp, %.1f s\n", timing.frames,
+            frame_w, frame_h, lv_color_format_get_bpp(frame_cf), seconds);
+
+    if (timing.frames == 0) {
+        return;
+    }
+
+    fprintf(stdout, "Offscreen: render avg %.1f us, worst %llu us, %.1f frames/s\n",
+            (double)timing.total_us / timing.frames, (unsigned long long)timing.worst_us,
+            seconds > 0 ? timing.frames / seconds : 0.0);
+}
+
+/**
+ * Check the dump file name pattern
+ *
+ * @param pattern the printf pattern from LV_OFFSCREEN_DUMP
+ * @return true if it has exactly one integer conversion, with optional
+ *         flags, width and precision but no length modifier, and no
+ *         other conversion than %%
+ * @description the pattern is passed to snprintf with the frame number
+ * only, anything else would be undefined behaviour
+ */
+static bool dump_pattern_valid(const char *pattern)
+{
+    const char *p = pattern;
+    int conversions = 0;
+
+    while ((p = strchr(p, '%')) != NULL) {
+        p++;
+        if (*p == '%') {
+            p++;
+            continue;
+        }
+
+        p += strspn(p, "-+ #0");
+        p += strspn(p, "0123456789");
+        if (*p == '.') {
+            p++;
+            p += strspn(p, "0123456789");
+        }
+
+        if (*p == '\0' || strchr("diouxX", *p) == NULL) {
+            return false;
+        }
+        p++;
+        conversions++;
+    }
+
+    return conversions == 1;
+}
+
+/**
+ * Write the frame to the file named after the dump pattern
+ *
+ * @param px_map the frame buffer
+ * @description a name ending with .png is written as PNG, others as PPM
+ */
+static void dump_frame(const uint8_t *px_map)
+{
+    char path[256];
+    FILE *f;
+    size_t len;
+    int ret;
+
+    snprintf(path, sizeof(path), dump_pattern, timing.frames);
+
+    f = fopen(path, "wb");
+    if (f == NULL) {
+        LV_LOG_WARN("Unable to open %s, frame dumps disabled", path);
+        dump_pattern = NULL;
+        return;
+    }
+
+    len = strlen(path);
+    if (len > 4 && strcmp(path + len - 4, ".png") == 0) {
+        ret = write_png(f, px_map);
+    } else {
+        ret = write_ppm(f, px_map);
+    }
+
+    if (fclose(f) != 0 || ret != 0) {
+        LV_LOG_WARN("Unable to write %s", path);
+    }
+}
+
+/**
+ * Convert a row of the frame buffer to 8 bit RGB
+ *
+ * @param src the row in the display color format
+ * @param dst frame_w RGB triplets
+ */
+static void row_to_rgb(const uint8_t *src, uint8_t *dst)
+{
+    uint32_t x;
+    uint16_t c;
+
+    for (x = 0; x < frame_w; x++) {
+        switch (frame_cf) {
+        case LV_COLOR_FORMAT_RGB565:
+            c = src[0] | (src[1] << 8);
+            dst[0] = ((c >> 11) & 0x1F) * 255 / 31;
+            dst[1] = ((c >> 5) & 0x3F) * 255 / 63;
+            dst[2] = (c & 0x1F) * 255 / 31;
+            src += 2;
+            break;
+        case LV_COLOR_FORMAT_RGB888:
+            dst[0] = src[2];
+            dst[1] = src[1];
+            dst[2] = src[0];
+            src += 3;
+            break;
+        default:
+            /* XRGB8888, stored as B, G, R, X */
+            dst[0] = src[2];
+            dst[1] = src[1];
+            dst[2] = src[0];
+            src += 4;
+            break;
+        }
+        dst += 3;
+    }
+}
+
+/**
+ * Write the frame as a binary PPM
+ *
+ * @param f the output file
+ * @param px_map the frame buffer
+ * @return 0 on success, -1 on error
+ */
+static int write_ppm(FILE *f, const uint8_t *px_map)
+{
+    uint8_t *row = malloc(frame_w * 3);
+    uint32_t y;
+    int ret = 0;
+
+    if (row == NULL) {
+        return -1;
+    }
+
+    fprintf(f, "P6\n%u %u\n255\n", frame_w, frame_h);
+
+    for (y = 0; y < frame_h && ret == 0; y++) {
+        row_to_rgb(px_map + y * frame_buf->header.stride, row);
+        if (fwrite(row, 3, frame_w, f) != frame_w) {
+            ret = -1;
+        }
+    }
+
+    free(row);
+    return ret;
+}
+
+/**
+ * Update a CRC-32 as used by PNG chunks
+ */
+static uint32_t crc32_update(uint32_t crc, const uint8_t *data, size_t len)
+{
+    static uint32_t table[256];
+    uint32_t c;
+    size_t i;
+    int k;
+
+    if (table[1] == 0) {
+        for (i = 0; i < 256; i++) {
+            c = i;
+            for (k = 0; k < 8; k++) {
+                c = c & 1 ? 0xEDB88320 ^ (c >> 1) : c >> 1;
+            }
+            table[i] = c;
+        }
+    }
+
+    crc = ~crc;
+    for (i = 0; i < len; i++) {
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+/**
+ * Store a 32 bit big endian value
+ */
+static void put_be32(uint8_t *p, uint32_t v)
+{
+    p[0] = v >> 24;
+    p[1] = v >> 16;
+    p[2] = v >> 8;
+    p[3] = v;
+}
+
+/**
+ * Write a PNG chunk
+ *
+ * @return 0 on success, -1 on error
+ */
+static int write_chunk(FILE *f, const char *type, const uint8_t *data, size_t len)
+{
+    uint8_t hdr[8];
+    uint8_t crc[4];
+
+    put_be32(hdr, len);
+    memcpy(hdr + 4, type, 4);
+    put_be32(crc, crc32_update(crc32_update(0, hdr + 4, 4), data, len));
+
+    if (fwrite(hdr, 1, 8, f) != 8 || fwrite(data, 1, len, f) != len ||
+        fwrite(crc, 1, 4, f) != 4) {
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Write the frame as an RGB PNG
+ *
+ * @param f the output file
+ * @param px_map the frame buffer
+ * @return 0 on success, -1 on error
+ * @description the image data is stored uncompressed (deflate stored
+ * blocks), dumps stay cheap to produce and need no zlib
+ */
+static int write_png(FILE *f, const uint8_t *px_map)
+{
+    static const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    size_t row_len = 1 + (size_t)frame_w * 3;
+    size_t raw_len = row_len * frame_h;
+    size_t blocks = (raw_len + DEFLATE_STORED_MAX - 1) / DEFLATE_STORED_MAX;
+    uint8_t ihdr[13];
+    uint8_t *idat;
+    uint8_t *raw;
+    uint8_t *p;
+    uint32_t a = 1;
+    uint32_t b = 0;
+    size_t i;
+    size_t n;
+    uint32_t y;
+    int ret;
+
+    /* zlib header, stored blocks of 5 header bytes each, adler-32 */
+    idat = malloc(2 + blocks * 5 + raw_len + 4);
+    raw = malloc(raw_len);
+    if (idat == NULL || raw == NULL) {
+        free(idat);
+        free(raw);
+        return -1;
+    }
+
+    for (y = 0; y < frame_h; y++) {
+        raw[y * row_len] = 0;   /* Filter type none */
+        row_to_rgb(px_map + y * frame_buf->header.stride, raw + y * row_len + 1);
+    }
+
+    p = idat;
+    *p++ = 0x78;
+    *p++ = 0x01;
+    for (i = 0; i < raw_len; i += n) {
+        n = raw_len - i < DEFLATE_STORED_MAX ? raw_len - i : DEFLATE_STORED_MAX;
+        *p++ = i + n == raw_len ? 1 : 0;
+        *p++ = n & 0xFF;
+        *p++ = n >> 8;
+        *p++ = ~n & 0xFF;
+        *p++ = (~n >> 8) & 0xFF;
+        memcpy(p, raw + i, n);
+        p += n;
+    }
+    for (i = 0; i < raw_len; i++) {
+        a = (a + raw[i]) % 65521;
+        b = (b + a) % 65521;
+    }
+    put_be32(p, (b << 16) | a);
+    p += 4;
+
+    put_be32(ihdr, frame_w);
+    put_be32(ihdr + 4, frame_h);
+    ihdr[8] = 8;    /* Bit depth */
+    ihdr[9] = 2;    /* Color type RGB */
+    ihdr[10] = 0;
+    ihdr[11] = 0;
+    ihdr[12] = 0;
+
+    ret = fwrite(signature, 1, sizeof(signature), f) == sizeof(signature) ? 0 : -1;
+    if (ret == 0) {
+        ret = write_chunk(f, "IHDR", ihdr, sizeof(ihdr));
+    }
+    if (ret == 0) {
+        ret = write_chunk(f, "IDAT", idat, p - idat);
+    }
+    if (ret == 0) {
+        ret = write_chunk(f, "IEND", NULL, 0);
+    }
+
+    free(raw);
+    free(idat);
+    return ret;
+}
+
+/**
+ * Get the monotonic time
+ *
+ * @return the time in microseconds
+ */
+static uint64_t now_us(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
@@ -0,0 +1,236 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <poll.h>
+#include <stdatomic.h>
+#include <sys/eventfd.h>
+#include "frame_pool.h"
+#include "frame_bus.h"
+
+struct frame_sub
+{
+    atomic_uintptr_t * ring; // frame_t *, 容量为2的幂
+    uint32_t ring_mask;
+    atomic_uint head; // 只由发布者推进
+    atomic_uint tail; // 消费者推进, DROP_OLDEST时发布者也会CAS推进
+    uint32_t type_mask;
+    frame_drop_policy policy;
+    atomic_uint dropped;
+    int efd; // 队列由空变非空时通知消费者
+};
+
+// 帧缓冲池, init时一次性分配, 接收路径上只做无锁出栈/入栈
+static frame_pool_t frame_pool;
+
+// 订阅者表, 发布时持读锁, 增删订阅者时持写锁
+static frame_sub_t * subs[FRAME_BUS_MAX_SUBS];
+static pthread_rwlock_t subs_lock = PTHREAD_RWLOCK_INITIALIZER;
+static uint32_t publish_seq       = 0;
+
+int frame_bus_init(void)
+{
+    return frame_pool_init(&frame_pool, sizeof(frame_t), FRAME_POOL_SIZE);
+}
+
+void frame_bus_pool_stats(frame_pool_stats * stats)
+{
+    frame_pool_get_stats(&frame_pool, stats);
+}
+
+frame_t * frame_bus_acquire(void)
+{
+    frame_t * frame = frame_pool_alloc(&frame_pool);
+
+    if(frame) atomic_store_explicit(&frame->refcnt, 1, memory_order_relaxed);
+    return frame;
+}
+
+void frame_release(frame_t * frame)
+{
+    if(frame == NULL || atomic_fetch_sub_explicit(&frame->refcnt, 1, memory_order_acq_rel) != 1) return;
+
+    frame_pool_free(&frame_pool, frame);
+}
+
+// 从队列尾部取出一帧, 消费者与DROP_OLDEST的发布者可能同时调用
+static frame_t * sub_pop(frame_sub_t * sub)
+{
+    unsigned int tail = atomic_load_explicit(&sub->tail, memory_order_acquire);
+    unsigned int head = atomic_load_explicit(&sub->head, memory_order_acquire);
+
+    for(;;) {
+        if(tail == head) {
+            // 判定为空前与sub_push的栅栏配对: 要么看到新的head, 要么发布者看到本线程推进后的tail并发出通知
+            atomic_thread_fence(memory_order_seq_cst);
+            head = atomic_load_explicit(&sub->head, memory_order_acquire);
+            if(tail == head) return NULL;
+        }
+        frame_t * frame = (frame_t *)atomic_load_explicit(&sub->ring[tail & sub->ring_mask], memory_order_relaxed);
+        if(atomic_compare_exchange_weak_explicit(&sub->tail, &tail, tail + 1, memory_order_acq_rel,
+                                                 memory_order_acquire)) {
+            return frame;
+        }
+        head = atomic_load_explicit(&sub->head, memory_order_acquire);
+    }
+}
+
+// 只由发布线程调用, 帧的引用已由调用方增加
+static void sub_push(frame_sub_t * sub, frame_t * frame)
+{
+    unsigned int head = atomic_load_explicit(&sub->head, memory_order_relaxed);
+    unsigned int tail = atomic_load_explicit(&sub->tail, memory_order_acquire);
+
+    if(head - tail > sub->ring_mask) {
+        atomic_fetch_add_explicit(&sub->dropped, 1, memory_order_relaxed);
+        if(sub->policy == FRAME_DROP_NEWEST) {
+            frame_release(frame);
+            return;
+        }
+        frame_release(sub_pop(sub));
+    }
+
+    atomic_store_explicit(&sub->ring[head & sub->ring_mask], (uintptr_t)frame, memory_order_relaxed);
+    atomic_store_explicit(&sub->head, head + 1, memory_order_release);
+
+    // 发布head之后再读tail: 入队前取的tail可能已过期, 消费者在此期间取空队列并回到poll就再也等不到通知
+    // 栅栏与sub_pop判空前的栅栏配对, tail等于本帧位置说明消费者可能已判定为空, 此时必须唤醒
+    atomic_thread_fence(memory_order_seq_cst);
+    tail = atomic_load_explicit(&sub->tail, memory_order_acquire);
+    if(tail == head) {
+        uint64_t one = 1;
+        if(write(sub->efd, &one, sizeof(one)) < 0 && errno != EAGAIN) perror("Frame bus notify failed");
+    }
+}
+
+void frame_bus_publish(frame_t * frame)
+{
+    uint32_t mask = FRAME_CHANNEL_MASK(frame->channel);
+
+    frame->seq = publish_seq++;
+
+    pthread_rwlock_rdlock(&subs_lock);
+    for(int i = 0; i < FRAME_BUS_MAX_SUBS; i++) {
+        frame_sub_t * sub = subs[i];
+        if(sub == NULL || (sub->type_mask & mask) == 0) continue;
+        atomic_fetch_add(&frame->refcnt, 1);
+        sub_push(sub, frame);
+    }
+    pthread_rwlock_unlock(&subs_lock);
+
+    frame_release(frame);
+}
+
+frame_sub_t * frame_bus_subscribe(uint32_t type_mask, uint16_t depth, frame_drop_policy policy)
+{
+    frame_sub_t * sub;
+    uint32_t capacity = 1;
+
+    while(capacity < depth) capacity <<= 1;
+
+    sub = calloc(1, sizeof(frame_sub_t));
+    if(sub == NULL) return NULL;
+    sub->ring = calloc(capacity, sizeof(atomic_uintptr_t));
+    sub->efd  = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if(sub->ring == NULL || sub->efd < 0) {
+        perror("Frame subscriber creation failed");
+        if(sub->efd >= 0) close(sub->efd);
+        free(sub->ring);
+        free(sub);
+        return NULL;
+    }
+    sub->ring_mask = capacity - 1;
+    sub->type_mask = type_mask;
+    sub->policy    = policy;
+
+    pthread_rwlock_wrlock(&subs_lock);
+    for(int i = 0; i < FRAME_BUS_MAX_SUBS; i++) {
+        if(subs[i] == NULL) {
+            subs[i] = sub;
+            pthread_rwlock_unlock(&subs_lock);
+            return sub;
+        }
+    }
+    pthread_rwlock_unlock(&subs_lock);
+
+    printf("Frame bus: too many subscribers\n");
+    close(sub->efd);
+    free(sub->ring);
+    free(sub);
+    return NULL;
+}
+
+void frame_bus_unsubscribe(frame_sub_t * sub)
+{
+    if(sub == NULL) return;
+
+    pthread_rwlock_wrlock(&subs_lock);
+    for(int i = 0; i < FRAME_BUS_MAX_SUBS; i++) {
+        if(subs[i] == sub) subs[i] = NULL;
+    }
+    pthread_rwlock_unlock(&subs_lock);
+
+    // 已不在订阅表中, 归还队列里残留的帧
+    frame_t * frame;
+    while((frame = sub_pop(sub)) != NULL) frame_release(frame);
+
+    close(sub->efd);
+    free(sub->ring);
+    free(sub);
+}
+
+int frame_bus_start_worker(frame_sub_t ** sub, uint32_t type_mask, uint16_t depth, frame_drop_policy policy,
+                           void * (*thread_func)(void *), const char * name)
+{
+    pthread_t thread;
+    int err;
+
+    *sub = frame_bus_subscribe(type_mask, depth, policy);
+    if(*sub == NULL) return -1;
+
+    err = pthread_create(&thread, NULL, thread_func, NULL);
+    if(err != 0) {
+        fprintf(stderr, "Failed to create %s thread: %s\n", name, strerror(err));
+        frame_bus_unsubscribe(*sub);
+        *sub = NULL;
+        return -1;
+    }
+    pthread_detach(thread);
+
+    return 0;
+}
+
+frame_t * frame_sub_poll(frame_sub_t * sub)
+{
+    return sub_pop(sub);
+}
+
+frame_t * frame_sub_wait(frame_sub_t * sub, int timeout_ms)
+{
+    frame_t * frame;
+    uint64_t count;
+
+    while((frame = sub_pop(sub)) == NULL) {
+        struct pollfd pfd = {.fd = sub->efd, .events = POLLIN};
+        int ret           = poll(&pfd, 1, timeout_ms);
+        if(ret == 0) return NULL;
+        if(ret < 0 && errno != EINTR) return NULL;
+        if(read(sub->efd, &count, sizeof(count)) < 0 && errno != EAGAIN) return NULL;
+    }
+
+    return frame;
+}
+
+int frame_sub_fd(const frame_sub_t * sub)
+{
+    return sub->efd;
+}
+
+uint32_t frame_sub_dropped(const frame_sub_t * sub)
+{
+    return atomic_load_explicit(&sub->dropped, memory_order_relaxed);
+}
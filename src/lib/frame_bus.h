@@ -0,0 +1,58 @@
+#ifndef FRAME_BUS_H
+#define FRAME_BUS_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include "rpmsg_protocol.h"
+#include "frame_pool.h"
+
+// 解码后的帧只发布一次, 所有订阅者共享同一块引用计数缓冲区
+#define FRAME_MAX_SAMPLES SENSOR_MAX_SAMPLES // 按协商上限分配, 帧长变化时无需重建缓冲池
+#define FRAME_POOL_SIZE 512   // 帧缓冲池容量, 不小于各订阅者队列深度之和
+#define FRAME_BUS_MAX_SUBS 16 // 订阅者上限
+
+// 订阅掩码, 按通道过滤, bit n 对应通道n
+#define FRAME_CHANNEL_MASK(ch) (1u << (ch))
+#define FRAME_MASK_REF FRAME_CHANNEL_MASK(SENSOR_CH_REF)
+#define FRAME_MASK_ERR FRAME_CHANNEL_MASK(SENSOR_CH_ERR)
+#define FRAME_MASK_ALL 0xFFFFFFFFu
+
+typedef struct frame
+{
+    atomic_int refcnt;
+    uint16_t msg_type;     // MSG_REF_ARRAY / MSG_ERR_ARRAY / MSG_MULTI_ARRAY
+    uint16_t channel;      // 通道号, 多通道帧按通道拆成多帧发布
+    uint16_t count;        // 有效采样点数
+    uint32_t seq;          // 发布序号, 由frame_bus_publish填写
+    uint32_t src_seq;      // 实时端发送序号, v1数据包为0
+    uint64_t timestamp_us; // 采样时刻(CLOCK_MONOTONIC, 微秒)
+    double voltage[FRAME_MAX_SAMPLES];
+} frame_t;
+
+typedef enum {
+    FRAME_DROP_NEWEST, // 队列满时丢弃新帧, 适合需要连续数据的订阅者(配合足够深的队列)
+    FRAME_DROP_OLDEST  // 队列满时丢弃最旧帧, 适合只关心最新数据的显示类订阅者
+} frame_drop_policy;
+
+typedef struct frame_sub frame_sub_t;
+
+int frame_bus_init(void);
+void frame_bus_pool_stats(frame_pool_stats * stats);
+
+// 发布端: 取空帧 -> 填充 -> 发布, 发布后发布者不再持有该帧
+frame_t * frame_bus_acquire(void);
+void frame_bus_publish(frame_t * frame);
+void frame_release(frame_t * frame);
+
+// 订阅端: 每个订阅者有独立的队列游标和丢帧策略, 取到的帧用完后frame_release
+frame_sub_t * frame_bus_subscribe(uint32_t type_mask, uint16_t depth, frame_drop_policy policy);
+void frame_bus_unsubscribe(frame_sub_t * sub);
+// 订阅并启动分离的处理线程, 线程开始运行前*sub已赋值; 失败时不保留订阅, 返回-1
+int frame_bus_start_worker(frame_sub_t ** sub, uint32_t type_mask, uint16_t depth, frame_drop_policy policy,
+                           void * (*thread_func)(void *), const char * name);
+frame_t * frame_sub_poll(frame_sub_t * sub);
+frame_t * frame_sub_wait(frame_sub_t * sub, int timeout_ms);
+int frame_sub_fd(const frame_sub_t * sub);
+uint32_t frame_sub_dropped(const frame_sub_t * sub);
+
+#endif // FRAME_BUS_H
@@ -0,0 +1,89 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "frame_pool.h"
+
+#define HEAD_INDEX(h) ((uint32_t)((h) & 0xFFFFFFFFu))
+#define HEAD_TAG(h) ((uint32_t)((h) >> 32))
+#define MAKE_HEAD(tag, index) (((uint_least64_t)(tag) << 32) | (uint32_t)(index))
+
+int frame_pool_init(frame_pool_t * pool, size_t block_size, uint32_t capacity)
+{
+    void * blocks;
+
+    // 块大小向上取整到缓存行, 相邻块不共享缓存行
+    block_size = (block_size + FRAME_POOL_CACHE_LINE - 1) & ~(size_t)(FRAME_POOL_CACHE_LINE - 1);
+
+    if(capacity == 0 || capacity >= FRAME_POOL_NIL) return -1;
+    if(posix_memalign(&blocks, FRAME_POOL_CACHE_LINE, block_size * capacity) != 0) {
+        perror("Frame pool allocation failed");
+        return -1;
+    }
+    pool->next = malloc(capacity * sizeof(atomic_uint));
+    if(pool->next == NULL) {
+        perror("Frame pool allocation failed");
+        free(blocks);
+        return -1;
+    }
+
+    // 预先触碰全部页面, 运行期不再产生缺页
+    memset(blocks, 0, block_size * capacity);
+    pool->blocks     = blocks;
+    pool->block_size = block_size;
+    pool->capacity   = capacity;
+    for(uint32_t i = 0; i < capacity; i++) atomic_init(&pool->next[i], i + 1 < capacity ? i + 1 : FRAME_POOL_NIL);
+    atomic_init(&pool->head, MAKE_HEAD(0, 0));
+    atomic_init(&pool->in_use, 0);
+    atomic_init(&pool->peak, 0);
+    atomic_init(&pool->exhausted, 0);
+
+    return 0;
+}
+
+void * frame_pool_alloc(frame_pool_t * pool)
+{
+    uint_least64_t head = atomic_load_explicit(&pool->head, memory_order_acquire);
+    uint_least64_t new_head;
+    uint32_t index;
+
+    // Treiber栈出栈, 版本号防止ABA
+    do {
+        index = HEAD_INDEX(head);
+        if(index == FRAME_POOL_NIL) {
+            atomic_fetch_add_explicit(&pool->exhausted, 1, memory_order_relaxed);
+            return NULL;
+        }
+        new_head = MAKE_HEAD(HEAD_TAG(head) + 1, atomic_load_explicit(&pool->next[index], memory_order_relaxed));
+    } while(!atomic_compare_exchange_weak_explicit(&pool->head, &head, new_head, memory_order_acq_rel,
+                                                   memory_order_acquire));
+
+    unsigned int in_use = atomic_fetch_add_explicit(&pool->in_use, 1, memory_order_relaxed) + 1;
+    unsigned int peak   = atomic_load_explicit(&pool->peak, memory_order_relaxed);
+    while(in_use > peak) {
+        if(atomic_compare_exchange_weak_explicit(&pool->peak, &peak, in_use, memory_order_relaxed, memory_order_relaxed))
+            break;
+    }
+
+    return pool->blocks + (size_t)index * pool->block_size;
+}
+
+void frame_pool_free(frame_pool_t * pool, void * block)
+{
+    uint32_t index      = (uint32_t)(((uint8_t *)block - pool->blocks) / pool->block_size);
+    uint_least64_t head = atomic_load_explicit(&pool->head, memory_order_relaxed);
+
+    do {
+        atomic_store_explicit(&pool->next[index], HEAD_INDEX(head), memory_order_relaxed);
+    } while(!atomic_compare_exchange_weak_explicit(&pool->head, &head, MAKE_HEAD(HEAD_TAG(head) + 1, index),
+                                                   memory_order_release, memory_order_relaxed));
+
+    atomic_fetch_sub_explicit(&pool->in_use, 1, memory_order_relaxed);
+}
+
+void frame_pool_get_stats(frame_pool_t * pool, frame_pool_stats * stats)
+{
+    stats->capacity  = pool->capacity;
+    stats->in_use    = atomic_load_explicit(&pool->in_use, memory_order_relaxed);
+    stats->peak      = atomic_load_explicit(&pool->peak, memory_order_relaxed);
+    stats->exhausted = atomic_load_explicit(&pool->exhausted, memory_order_relaxed);
+}
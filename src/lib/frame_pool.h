@@ -0,0 +1,39 @@
+#ifndef FRAME_POOL_H
+#define FRAME_POOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdatomic.h>
+
+// 定长块内存池: 启动时一次性分配, 之后分配/释放只操作无锁空闲链表, 不再调用malloc
+#define FRAME_POOL_CACHE_LINE 64
+#define FRAME_POOL_NIL 0xFFFFFFFFu
+
+typedef struct
+{
+    uint32_t capacity;  // 块总数
+    uint32_t in_use;    // 当前占用块数
+    uint32_t peak;      // 占用峰值
+    uint32_t exhausted; // 池耗尽导致分配失败的次数
+} frame_pool_stats;
+
+typedef struct
+{
+    // 空闲链表头: 低32位为块号, 高32位为ABA版本号
+    atomic_uint_least64_t head __attribute__((aligned(FRAME_POOL_CACHE_LINE)));
+    // 统计计数器与链表头分属不同缓存行, 避免伪共享
+    atomic_uint in_use __attribute__((aligned(FRAME_POOL_CACHE_LINE)));
+    atomic_uint peak;
+    atomic_uint exhausted;
+    uint8_t * blocks; // 按缓存行对齐的块存储区
+    atomic_uint * next; // 空闲链表中每个块的后继块号
+    size_t block_size;
+    uint32_t capacity;
+} frame_pool_t;
+
+int frame_pool_init(frame_pool_t * pool, size_t block_size, uint32_t capacity);
+void * frame_pool_alloc(frame_pool_t * pool);
+void frame_pool_free(frame_pool_t * pool, void * block);
+void frame_pool_get_stats(frame_pool_t * pool, frame_pool_stats * stats);
+
+#endif // FRAME_POOL_H
@@ -12,36 +12,53 @@
 #include "lvgl/lvgl.h"
 #include "linux_msg.h"
 #include "rpmsg_protocol.h"
+#include "frame_bus.h"
+#include "rpmsg_codec.h"
+#include "rpmsg_schema.h"
+#include "crc32c.h"
 
 #define MSG_PATH "/dev/ttyRPMSG0"
-#define Y_SCALE 1024
+#define LOGGER_QUEUE_DEPTH 128 // 日志订阅者队列深度, 吸收NFS写入抖动, 多通道时每个采样块占多个槽位
+#define PARAM_CACHE_SIZE 16 // 参数缓存容量, 覆盖param_type中全部参数ID
 
 // 全局变量
-int rpmsg_fd;
-FILE * ref_file;
-FILE * err_file;
+int rpmsg_fd = -1;
+FILE * channel_files[SENSOR_MAX_CHANNELS]; // 每通道一个数据文件, 参考/误差通道启动时创建, 其余首帧到达时创建
 
-bool has_new_ref_signal      = false;
-bool has_new_err_signal      = false;
 pthread_mutex_t g_mutex_lock = PTHREAD_MUTEX_INITIALIZER; // 保护send_msg调用
 atomic_bool should_exit      = false;
 pthread_mutex_t io_mutex     = PTHREAD_MUTEX_INITIALIZER;
 pthread_cond_t io_cond       = PTHREAD_COND_INITIALIZER;
 int ongoing_io_count         = 0;
-
-int16_t ref_signal_array[200]                       = {0};
-int16_t err_signal_array[200]                       = {0};
-double ref_voltage[REF_SIGNAL_ARRAY_SIZE]           = {0.0};
-double err_voltage[REF_SIGNAL_ARRAY_SIZE]           = {0.0};
-int32_t converted_ref_values[REF_SIGNAL_ARRAY_SIZE] = {0};
-int32_t converted_err_values[ERR_SIGNAL_ARRAY_SIZE] = {0};
-double ref_max_val                                  = -10.0;
-double ref_min_val                                  = 10.0;
-double err_max_val                                  = -10.0;
-double err_min_val                                  = 10.0;
-
-extern lv_obj_t * ref_label;
-extern lv_obj_t * err_label;
+pthread_mutex_t decode_mutex = PTHREAD_MUTEX_INITIALIZER; // 接收线程与注入接口串行发布帧
+
+// 接收解码器, 计数器供统计接口读取
+static rpmsg_decoder rx_decoder;
+static rpmsg_decoder inject_decoder;
+static atomic_bool peer_v2 = false; // 实时端发过v2帧后, 下发命令也使用v2帧头
+static uint32_t tx_seq     = 0;
+
+// 当前数据流配置, 收到MSG_STREAM_CONFIG后更新; 未握手时按v1固定帧长
+static atomic_uint stream_frame_samples = REF_SIGNAL_ARRAY_SIZE;
+static atomic_uint stream_sample_rate   = 0; // 0表示未知
+// 握手请求值, 默认全0即查询实时端当前配置, 环境变量可覆盖; 在启动接收线程前确定
+static StreamConfig stream_hello;
+
+// 接收分发表, 首次使用时注册Linux侧处理的消息
+static rpmsg_dispatcher rx_dispatcher;
+static pthread_once_t rx_dispatcher_once = PTHREAD_ONCE_INIT;
+
+// 实时端状态, 由接收线程更新, 统计接口随时读取
+#define HEARTBEAT_TIMEOUT_US (3ull * RPMSG_HEARTBEAT_PERIOD_MS * 1000) // 连续丢失3个心跳周期即告警
+static atomic_uint peer_state                  = 0;
+static atomic_uint peer_heartbeats             = 0;
+static atomic_uint peer_errors                 = 0;
+static atomic_uint peer_last_error             = 0;
+static atomic_uint_least64_t peer_heartbeat_us = 0; // 最近一次心跳的接收时刻
+
+// 最近一次成功下发的参数值, 实时核不回读参数, 由Linux侧缓存
+static double param_values[PARAM_CACHE_SIZE];
+static bool param_valid[PARAM_CACHE_SIZE];
 
 // 设置TTY为原始模式
 int set_tty_raw(int fd)
@@ -71,70 +88,65 @@ int set_tty_raw(int fd)
     return 0;
 }
 
+// 发送已封装好的消息, 调用方持有g_mutex_lock
+static int rpmsg_write_locked(const uint8_t * data, size_t len)
+{
+    if(write(rpmsg_fd, data, len) != (ssize_t)len) {
+        perror("Failed to send command");
+        return -1;
+    }
+
+    return 0;
+}
+
 int send_msg(int cmd_type, u_int16_t param_id, double param_value)
 {
-    rpmsg_packet pkt;
-    size_t pkt_size = 0;
-    bool valid_cmd  = true;
+    uint16_t command = 0;
+    ParamPayload param;
+    bool valid_cmd = true;
 
     // 加锁保护，防止并发调用冲突
     pthread_mutex_lock(&g_mutex_lock);
 
     switch(cmd_type) {
         case CMD_START_EXCITATION: {
-            pkt.msg_type        = MSG_COMMAND;
-            pkt.payload.command = START_EXCITATION;
-            pkt_size            = sizeof(pkt.msg_type) + sizeof(u_int16_t);
+            command = START_EXCITATION;
             printf("Sending: Start excitation...\n");
             break;
         }
         case CMD_STOP_EXCITATION: {
-            pkt.msg_type        = MSG_COMMAND;
-            pkt.payload.command = STOP_EXCITATION;
-            pkt_size            = sizeof(pkt.msg_type) + sizeof(u_int16_t);
+            command = STOP_EXCITATION;
             printf("Sending: Stop excitation...\n");
             break;
         }
         case CMD_START_CONTROL: {
-            pkt.msg_type        = MSG_COMMAND;
-            pkt.payload.command = START_CONTROL;
-            pkt_size            = sizeof(pkt.msg_type) + sizeof(u_int16_t);
+            command = START_CONTROL;
             printf("Sending: Start control...\n");
             break;
         }
         case CMD_STOP_CONTROL: {
-            pkt.msg_type        = MSG_COMMAND;
-            pkt.payload.command = STOP_CONTROL;
-            pkt_size            = sizeof(pkt.msg_type) + sizeof(u_int16_t);
+            command = STOP_CONTROL;
             printf("Sending: Stop control...\n");
             break;
         }
         case CMD_START_IDENTIFY: {
-            pkt.msg_type        = MSG_COMMAND;
-            pkt.payload.command = START_SP_IDENTIFY;
-            pkt_size            = sizeof(pkt.msg_type) + sizeof(u_int16_t);
+            command = START_SP_IDENTIFY;
             printf("Sending: Start identify...\n");
             break;
         }
         case CMD_STOP_IDENTIFY: {
-            pkt.msg_type        = MSG_COMMAND;
-            pkt.payload.command = STOP_SP_IDENTIFY;
-            pkt_size            = sizeof(pkt.msg_type) + sizeof(u_int16_t);
+            command = STOP_SP_IDENTIFY;
             printf("Sending: Stop identify...\n");
             break;
         }
         case CMD_SET_PARAM: {
-            pkt.msg_type                  = MSG_SET_PARAM;
-            pkt.payload.param.param_id    = param_id;
-            pkt.payload.param.param_value = param_value;
-            pkt_size                      = sizeof(pkt.msg_type) + sizeof(ParamPayload);
+            param.param_id    = param_id;
+            param.param_value = param_value;
             printf("Sending: Set param ID %u to %.2f\n", param_id, param_value);
             break;
         }
         case CMD_GET_ARRAY: {
-            pkt.msg_type        = MSG_COMMAND;
-            pkt.payload.command = START_DAMPING; // 假设START_DAMPING用于请求数据
-            pkt_size            = sizeof(pkt.msg_type) + sizeof(u_int16_t);
+            command = START_DAMPING; // 假设START_DAMPING用于请求数据
             printf("Sending: Sensor array request...\n");
             break;
         }
@@ -148,19 +160,32 @@ int send_msg(int cmd_type, u_int16_t param_id, double param_value)
             }
             pthread_mutex_unlock(&io_mutex);
             close(rpmsg_fd);
-            fclose(ref_file);
-            fclose(err_file);
+            for(int ch = 0; ch < SENSOR_MAX_CHANNELS; ch++) {
+                if(channel_files[ch]) fclose(channel_files[ch]);
+            }
             pthread_mutex_unlock(&g_mutex_lock);
             exit(0);
         }
         default: printf("Invalid command.\n"); valid_cmd = false;
     }
-    int send_result = 0;
+    int send_result = valid_cmd ? 0 : -1;
     if(valid_cmd) {
-        size_t sent = write(rpmsg_fd, &pkt, pkt_size);
-        if(sent != (size_t)pkt_size) {
-            perror("Failed to send command");
+        // 实时端发过v2帧后使用v2帧头, 否则按v1格式发送
+        uint8_t tx_buffer[RPMSG_TX_MAX];
+        bool v2 = atomic_load(&peer_v2);
+        size_t tx_size;
+
+        if(cmd_type == CMD_SET_PARAM)
+            tx_size = rpmsg_pack_SET_PARAM(tx_buffer, v2, &param, tx_seq, rpmsg_now_us());
+        else
+            tx_size = rpmsg_pack_COMMAND(tx_buffer, v2, &command, tx_seq, rpmsg_now_us());
+        if(v2) tx_seq++;
+
+        if(rpmsg_write_locked(tx_buffer, tx_size) < 0) {
             send_result = -1;
+        } else if(cmd_type == CMD_SET_PARAM && param_id < PARAM_CACHE_SIZE) {
+            param_values[param_id] = param_value;
+            param_valid[param_id]  = true;
         }
     }
     usleep(100000); // 100ms延迟
@@ -169,6 +194,61 @@ int send_msg(int cmd_type, u_int16_t param_id, double param_value)
     return send_result;
 }
 
+// 向实时端提出期望的帧长与采样率, 实际生效值以MSG_STREAM_CONFIG应答为准
+int rpmsg_request_stream(uint16_t frame_samples, uint32_t sample_rate)
+{
+    StreamConfig hello = {.frame_samples = frame_samples, .reserved = 0, .sample_rate = sample_rate};
+    uint8_t tx_buffer[RPMSG_TX_MAX];
+    int result;
+
+    if(frame_samples > SENSOR_MAX_SAMPLES) return -1;
+
+    pthread_mutex_lock(&g_mutex_lock);
+    printf("Sending: Stream hello, %u samples/frame, %u Hz\n", frame_samples, sample_rate);
+    // 握手消息只有v2格式
+    result = rpmsg_write_locked(tx_buffer, rpmsg_pack_STREAM_HELLO(tx_buffer, true, &hello, tx_seq++, rpmsg_now_us()));
+    pthread_mutex_unlock(&g_mutex_lock);
+
+    return result;
+}
+
+// 请求实时端从offset处重发辨识系数, 只有v2格式
+int rpmsg_request_coeff(uint32_t ident_id, uint16_t offset)
+{
+    CoeffRequest request = {.ident_id = ident_id, .offset = offset, .reserved = 0};
+    uint8_t tx_buffer[RPMSG_TX_MAX];
+    int result;
+
+    pthread_mutex_lock(&g_mutex_lock);
+    printf("Sending: Coefficient request, identification %u from tap %u\n", ident_id, offset);
+    result = rpmsg_write_locked(tx_buffer,
+                                rpmsg_pack_COEFF_REQUEST(tx_buffer, true, &request, tx_seq++, rpmsg_now_us()));
+    pthread_mutex_unlock(&g_mutex_lock);
+
+    return result;
+}
+
+void rpmsg_get_stream(StreamConfig * config)
+{
+    config->frame_samples = (uint16_t)atomic_load(&stream_frame_samples);
+    config->reserved      = 0;
+    config->sample_rate   = atomic_load(&stream_sample_rate);
+}
+
+int get_param(u_int16_t param_id, double * param_value)
+{
+    int result = -1;
+
+    pthread_mutex_lock(&g_mutex_lock);
+    if(param_id < PARAM_CACHE_SIZE && param_valid[param_id]) {
+        *param_value = param_values[param_id];
+        result       = 0;
+    }
+    pthread_mutex_unlock(&g_mutex_lock);
+
+    return result;
+}
+
 // 合并后的命令输入和发送线程函数
 void * cmd_send_thread_func(void * arg)
 {
@@ -188,6 +268,11 @@ void * cmd_send_thread_func(void * arg)
                "8: Request sensor array\n"
                "0: Exit\n");
         ret = scanf("%d", &cmd);
+        if(ret == EOF) {
+            // 标准输入已关闭(无人值守运行), 改由控制socket下发命令
+            printf("stdin closed, console command input disabled\n");
+            break;
+        }
         if(ret != 1) {
             // 清除无效输入
             int c;
@@ -219,134 +304,427 @@ void * cmd_send_thread_func(void * arg)
     return NULL;
 }
 
-void * get_array_thread_func(void * arg)
+#define SAMPLE_TO_VOLT(sample) ((sample) * 10.0 / 32767.0f) // 32768 = 0x8000
+
+// 一次取齐count个空帧, 任一失败则全部归还, 同一采样块的各通道要么全部发布要么全部丢弃
+static bool acquire_frames(frame_t ** frames, int count)
 {
-    struct pollfd fds     = {.fd = rpmsg_fd, .events = POLLIN};
-    const size_t pkt_size = sizeof(u_int16_t) + sizeof(SensorArray);
-    uint8_t recv_buffer[sizeof(rpmsg_packet) * 2];
-    size_t bytes_received = 0;
+    static bool pool_warned = false;
 
-    printf("Sensor monitor thread started\n");
-    (void)arg;
+    for(int i = 0; i < count; i++) {
+        frames[i] = frame_bus_acquire();
+        if(frames[i] != NULL) continue;
 
-    time_t rawtime;
-    struct tm * timeinfo;
+        while(i-- > 0) frame_release(frames[i]);
+        if(!pool_warned) {
+            printf("WARNING: frame pool exhausted, frames dropped\n");
+            pool_warned = true;
+        }
+        return false;
+    }
+    pool_warned = false;
+
+    return true;
+}
+
+static void fill_frame_header(frame_t * frame, const rpmsg_msg * msg, uint16_t channel, uint16_t count)
+{
+    frame->msg_type     = msg->msg_type;
+    frame->channel      = channel;
+    frame->count        = count;
+    frame->src_seq      = msg->seq;
+    frame->timestamp_us = msg->timestamp_us;
+}
+
+// 解码一帧单通道传感器数组并发布到帧总线
+// v2帧长度由帧头给出, 不要求与协商值一致, 配置切换期间的帧照常显示; 长度范围已由消息表校验
+static void handle_sensor_array(const rpmsg_msg * msg, void * user_data)
+{
+    frame_t * frame;
+    int16_t sample;
+    uint16_t count = msg->length / sizeof(sample);
+
+    (void)user_data;
+
+    if(!acquire_frames(&frame, 1)) return;
+
+    fill_frame_header(frame, msg, msg->msg_type == MSG_REF_ARRAY ? SENSOR_CH_REF : SENSOR_CH_ERR, count);
+    for(int i = 0; i < count; i++) {
+        memcpy(&sample, msg->payload + i * sizeof(sample), sizeof(sample));
+        frame->voltage[i] = SAMPLE_TO_VOLT(sample);
+    }
+
+    pthread_mutex_lock(&decode_mutex);
+    frame_bus_publish(frame);
+    pthread_mutex_unlock(&decode_mutex);
+}
+
+// 解码多通道交织数组: 顺序扫描一遍负载, 直接写入各通道帧的平面缓冲区
+static void handle_multi_array(const rpmsg_msg * msg, void * user_data)
+{
+    frame_t * frames[SENSOR_MAX_CHANNELS];
+    MultiArrayHeader hdr;
+    const uint8_t * src;
+    int16_t sample;
+    int channels;
+
+    (void)user_data;
+
+    memcpy(&hdr, msg->payload, sizeof(hdr));
+    channels = __builtin_popcount(hdr.channel_mask);
+    if(channels == 0 || (hdr.channel_mask >> SENSOR_MAX_CHANNELS) != 0 || hdr.samples == 0 ||
+       hdr.samples > SENSOR_MAX_SAMPLES ||
+       msg->length != sizeof(hdr) + (size_t)hdr.samples * channels * sizeof(sample)) {
+        printf("WARNING: multi-channel array mask 0x%X, %u samples, length %u not supported\n", hdr.channel_mask,
+               hdr.samples, msg->length);
+        return;
+    }
+    if(!acquire_frames(frames, channels)) return;
+
+    for(int ch = 0, k = 0; ch < SENSOR_MAX_CHANNELS; ch++) {
+        if(hdr.channel_mask & (1u << ch)) fill_frame_header(frames[k++], msg, (uint16_t)ch, hdr.samples);
+    }
+
+    src = msg->payload + sizeof(hdr);
+    for(int i = 0; i < hdr.samples; i++) {
+        for(int k = 0; k < channels; k++) {
+            memcpy(&sample, src, sizeof(sample));
+            src += sizeof(sample);
+            frames[k]->voltage[i] = SAMPLE_TO_VOLT(sample);
+        }
+    }
+
+    pthread_mutex_lock(&decode_mutex);
+    for(int k = 0; k < channels; k++) frame_bus_publish(frames[k]);
+    pthread_mutex_unlock(&decode_mutex);
+}
+
+static void handle_stream_config(const rpmsg_msg * msg, void * user_data)
+{
+    StreamConfig config;
+
+    (void)user_data;
+
+    memcpy(&config, msg->payload, sizeof(config));
+    // 解码缓冲区按SENSOR_MAX_SAMPLES确定, 超出的帧长无法接收, 不予采用
+    if(config.frame_samples == 0 || config.frame_samples > SENSOR_MAX_SAMPLES) {
+        printf("WARNING: stream config with %u samples/frame not supported, ignored\n", config.frame_samples);
+        return;
+    }
+    atomic_store(&stream_frame_samples, config.frame_samples);
+    atomic_store(&stream_sample_rate, config.sample_rate);
+    printf("Stream configured: %u samples/frame, %u Hz\n", config.frame_samples, config.sample_rate);
+}
+
+static void handle_status(const rpmsg_msg * msg, void * user_data)
+{
+    StatusPayload status;
+
+    (void)user_data;
+
+    memcpy(&status, msg->payload, sizeof(status));
+    if(atomic_exchange(&peer_state, status.state) != status.state) {
+        printf("Real-time core state 0x%02X, load %.1f%%\n", status.state, status.cpu_load / 10.0);
+    }
+}
+
+static void handle_heartbeat(const rpmsg_msg * msg, void * user_data)
+{
+    (void)msg;
+    (void)user_data;
+
+    atomic_fetch_add(&peer_heartbeats, 1);
+    atomic_store(&peer_heartbeat_us, rpmsg_now_us());
+}
+
+static void handle_log(const rpmsg_msg * msg, void * user_data)
+{
+    static const char * const level_names[] = {"ERROR", "WARN", "INFO", "DEBUG"};
+    LogHeader hdr;
+
+    (void)user_data;
+
+    memcpy(&hdr, msg->payload, sizeof(hdr));
+    printf("[RT %s] %.*s\n", hdr.level < 4 ? level_names[hdr.level] : "?", (int)(msg->length - sizeof(hdr)),
+           (const char *)msg->payload + sizeof(hdr));
+}
+
+static void handle_error(const rpmsg_msg * msg, void * user_data)
+{
+    ErrorPayload error;
+
+    (void)user_data;
+
+    memcpy(&error, msg->payload, sizeof(error));
+    atomic_fetch_add(&peer_errors, 1);
+    atomic_store(&peer_last_error, error.code);
+    printf("ERROR: real-time core error 0x%04X, detail 0x%08X\n", error.code, error.detail);
+}
+
+// Linux侧接收的消息, 其余消息类型在消息表中但只由Linux发出
+static void rx_dispatcher_init(void)
+{
+    rpmsg_dispatcher_init(&rx_dispatcher);
+    rpmsg_dispatcher_register(&rx_dispatcher, MSG_REF_ARRAY, handle_sensor_array, NULL);
+    rpmsg_dispatcher_register(&rx_dispatcher, MSG_ERR_ARRAY, handle_sensor_array, NULL);
+    rpmsg_dispatcher_register(&rx_dispatcher, MSG_MULTI_ARRAY, handle_multi_array, NULL);
+    rpmsg_dispatcher_register(&rx_dispatcher, MSG_STREAM_CONFIG, handle_stream_config, NULL);
+    rpmsg_dispatcher_register(&rx_dispatcher, MSG_STATUS, handle_status, NULL);
+    rpmsg_dispatcher_register(&rx_dispatcher, MSG_HEARTBEAT, handle_heartbeat, NULL);
+    rpmsg_dispatcher_register(&rx_dispatcher, MSG_LOG, handle_log, NULL);
+    rpmsg_dispatcher_register(&rx_dispatcher, MSG_ERROR, handle_error, NULL);
+}
+
+// 其他模块注册或替换消息处理函数, 须在start_rpmsg之前调用
+int rpmsg_register_handler(uint16_t msg_type, rpmsg_handler handler, void * user_data)
+{
+    pthread_once(&rx_dispatcher_once, rx_dispatcher_init);
+    return rpmsg_dispatcher_register(&rx_dispatcher, msg_type, handler, user_data);
+}
+
+void rpmsg_get_peer_status(rpmsg_peer_status * status)
+{
+    uint64_t last = atomic_load(&peer_heartbeat_us);
+
+    status->state            = atomic_load(&peer_state);
+    status->heartbeats       = atomic_load(&peer_heartbeats);
+    status->errors           = atomic_load(&peer_errors);
+    status->last_error       = atomic_load(&peer_last_error);
+    status->heartbeat_age_ms = last ? (uint32_t)((rpmsg_now_us() - last) / 1000) : UINT32_MAX;
+}
+
+static void on_rpmsg_msg(const rpmsg_msg * msg, void * user_data)
+{
+    static bool warn_printed = false;
+
+    (void)user_data;
+
+    // 首次收到v2帧说明实时端支持握手, 此时才发HELLO, v1固件不会收到v2帧头
+    // 应答MSG_STREAM_CONFIG给出实际生效的帧长和采样率
+    if(msg->version == RPMSG_V2_VERSION && !atomic_exchange(&peer_v2, true)) {
+        rpmsg_request_stream(stream_hello.frame_samples, stream_hello.sample_rate);
+    }
+
+    // v2帧自带长度, 无法处理的消息直接跳过, 无需重同步
+    switch(rpmsg_dispatch(&rx_dispatcher, msg)) {
+        case RPMSG_DISPATCH_OK: break;
+        case RPMSG_DISPATCH_BAD_LEN:
+            printf("WARNING: message type 0x%04X with length %u, ignored\n", msg->msg_type, msg->length);
+            break;
+        default:
+            if(!warn_printed) {
+                printf("WARNING: Unknown message type: 0x%04X, ignored\n", msg->msg_type);
+                warn_printed = true;
+            }
+    }
+}
+
+// 打开通道数据文件, 文件名带记录线程启动时刻
+static FILE * open_channel_file(uint16_t channel, const struct tm * start_time)
+{
+    char format[64];
     char filename[80];
-    time(&rawtime);
-    timeinfo = localtime(&rawtime);
-    strftime(filename, sizeof(filename), "./nfsfolder/HI3093/err_data-%H-%M-%S.bin", timeinfo);
-    err_file = fopen(filename, "wb");
-    if(err_file == NULL) {
+    FILE * file;
+
+    if(channel == SENSOR_CH_REF)
+        snprintf(format, sizeof(format), "./nfsfolder/HI3093/ref_data-%%H-%%M-%%S.bin");
+    else if(channel == SENSOR_CH_ERR)
+        snprintf(format, sizeof(format), "./nfsfolder/HI3093/err_data-%%H-%%M-%%S.bin");
+    else
+        snprintf(format, sizeof(format), "./nfsfolder/HI3093/ch%02u_data-%%H-%%M-%%S.bin", channel);
+    strftime(filename, sizeof(filename), format, start_time);
+
+    file = fopen(filename, "wb");
+    if(file == NULL)
         perror("File creation failed");
+    else
+        printf("Data file created: %s\n", filename);
+
+    return file;
+}
+
+// 数据文件记录线程, 作为帧总线订阅者运行
+void * frame_logger_thread_func(void * arg)
+{
+    frame_sub_t * sub = arg;
+    bool open_failed[SENSOR_MAX_CHANNELS] = {false};
+
+    time_t rawtime;
+    struct tm start_time;
+    time(&rawtime);
+    localtime_r(&rawtime, &start_time);
+    channel_files[SENSOR_CH_ERR] = open_channel_file(SENSOR_CH_ERR, &start_time);
+    if(channel_files[SENSOR_CH_ERR] == NULL) {
+        frame_bus_unsubscribe(sub);
         return NULL;
     }
-    strftime(filename, sizeof(filename), "./nfsfolder/HI3093/ref_data-%H-%M-%S.bin", timeinfo);
-    ref_file = fopen(filename, "wb");
-    if(ref_file == NULL) {
-        perror("File creation failed");
-        fclose(err_file);
+    channel_files[SENSOR_CH_REF] = open_channel_file(SENSOR_CH_REF, &start_time);
+    if(channel_files[SENSOR_CH_REF] == NULL) {
+        fclose(channel_files[SENSOR_CH_ERR]);
+        channel_files[SENSOR_CH_ERR] = NULL;
+        frame_bus_unsubscribe(sub);
         return NULL;
     }
 
-    printf("Data files created: %s\n", filename);
+    while(!atomic_load(&should_exit)) {
+        frame_t * frame = frame_sub_wait(sub, 500);
+        if(frame == NULL) continue;
 
-    while(1) {
-        if(poll(&fds, 1, -1) <= 0) {
-            if(errno != EINTR) perror("poll error");
-            continue;
-        }
-
-        ssize_t n = read(rpmsg_fd, recv_buffer + bytes_received, sizeof(recv_buffer) - bytes_received);
-        if(n <= 0) {
-            if(n == 0)
-                printf("Connection closed\n");
-            else if(errno != EAGAIN && errno != EWOULDBLOCK)
-                perror("Read error");
+        // 先登记再写文件, 退出流程会等待写入完成后再关闭文件
+        pthread_mutex_lock(&io_mutex);
+        if(atomic_load(&should_exit)) {
+            pthread_mutex_unlock(&io_mutex);
+            frame_release(frame);
             break;
         }
-        bytes_received += (size_t)n;
+        ongoing_io_count++;
+        pthread_mutex_unlock(&io_mutex);
+
+        // 其余通道首帧到达时才创建文件, 创建失败后不再重试
+        FILE ** file = &channel_files[frame->channel];
+        if(*file == NULL && !open_failed[frame->channel]) {
+            *file                       = open_channel_file(frame->channel, &start_time);
+            open_failed[frame->channel] = *file == NULL;
+        }
+        if(*file != NULL) fwrite(frame->voltage, sizeof(double), frame->count, *file);
+        frame_release(frame);
+
+        pthread_mutex_lock(&io_mutex);
+        ongoing_io_count--;
+        pthread_cond_signal(&io_cond); // 通知等待线程
+        pthread_mutex_unlock(&io_mutex);
+    }
 
-        static bool warn_printed = false;
+    return NULL;
+}
 
-        while(!atomic_load(&should_exit) && bytes_received >= sizeof(u_int16_t)) {
-            u_int16_t msg_type;
-            memcpy(&msg_type, recv_buffer, sizeof(u_int16_t));
+// 注入rpmsg数据(v1或v2), 与实时核发来的数据走同一解码路径
+int rpmsg_inject(const void * data, size_t len)
+{
+    // 每次注入都是完整数据包, 不保留上一次的残余字节
+    pthread_once(&rx_dispatcher_once, rx_dispatcher_init);
+    rpmsg_decoder_init(&inject_decoder);
+    return rpmsg_decoder_feed(&inject_decoder, data, len, on_rpmsg_msg, NULL) > 0 ? 0 : -1;
+}
 
-            if(msg_type != MSG_REF_ARRAY && msg_type != MSG_ERR_ARRAY) {
-                if(!warn_printed) {
-                    printf("WARNING: Unknown message type: 0x%04X (data may be misaligned)\n", msg_type);
-                    warn_printed = true; // 置为true，后续不再打印
-                }
-                memmove(recv_buffer, recv_buffer + 1, --bytes_received);
-                continue;
-            }
+void rpmsg_get_rx_stats(rpmsg_rx_stats * stats)
+{
+    rpmsg_decoder_get_stats(&rx_decoder, stats);
+}
 
-            warn_printed = false; // 重置警告打印标志
+void * get_array_thread_func(void * arg)
+{
+    struct pollfd fds   = {.fd = rpmsg_fd, .events = POLLIN};
+    uint32_t resyncs    = 0;
+    uint32_t crc_errors = 0;
+    bool heartbeat_lost = false;
 
-            if(bytes_received < pkt_size) break;
+    printf("Sensor monitor thread started\n");
+    (void)arg;
 
-            rpmsg_packet pkt;
-            memcpy(&pkt, recv_buffer, pkt_size);
+    while(!atomic_load(&should_exit)) {
+        int ready = poll(&fds, 1, RPMSG_HEARTBEAT_PERIOD_MS);
 
-            pthread_mutex_lock(&io_mutex);
-            ongoing_io_count++;
-            pthread_mutex_unlock(&io_mutex);
+        // 收到过心跳后才开始监视, 旧固件不发心跳
+        uint64_t last = atomic_load(&peer_heartbeat_us);
+        bool stale    = last != 0 && rpmsg_now_us() - last > HEARTBEAT_TIMEOUT_US;
+        if(stale != heartbeat_lost) {
+            printf(stale ? "WARNING: real-time core heartbeat lost\n" : "Real-time core heartbeat restored\n");
+            heartbeat_lost = stale;
+        }
 
-            if(msg_type == MSG_REF_ARRAY) {
-                int wait = 10000;
-                while(has_new_ref_signal == true) {
-                    wait--;
-                    if(wait < 0) {
-                        printf("WARNING: array processing unfinished!");
-                        break;
-                    }
-                }
-                memcpy(ref_signal_array, pkt.payload.array, sizeof(SensorArray));
-                static int ref_scale = 1 * (1024 - 20);
-                for(int i = 0; i < REF_SIGNAL_ARRAY_SIZE; i++) {
-                    ref_voltage[i]          = ref_signal_array[i] * 10.0 / 32767.0f; // 32768 = 0x8000
-                    converted_ref_values[i] = (int32_t)(ref_voltage[i] / 10.0 * ref_scale);
-                    if(ref_voltage[i] > ref_max_val) ref_max_val = ref_voltage[i];
-                    if(ref_voltage[i] < ref_min_val) ref_min_val = ref_voltage[i];
-                }
-                fwrite(ref_voltage, sizeof(double), REF_SIGNAL_ARRAY_SIZE, ref_file);
-                has_new_ref_signal = true;
-            } else if(msg_type == MSG_ERR_ARRAY) {
-                int wait = 10000;
-                while(has_new_err_signal == true) {
-                    wait--;
-                    if(wait < 0) {
-                        printf("WARNING: array processing unfinished!");
-                        break;
-                    }
-                }
-                memcpy(err_signal_array, pkt.payload.array, sizeof(SensorArray));
-                static int err_scale = 1 * (Y_SCALE - 20);
-                for(int i = 0; i < ERR_SIGNAL_ARRAY_SIZE; i++) {
-                    err_voltage[i]          = err_signal_array[i] * 10.0 / 32767.0f; // 32768 = 0x8000
-                    converted_err_values[i] = (int32_t)(err_voltage[i] / 10.0 * err_scale);
-                    if(err_voltage[i] > err_max_val) err_max_val = err_voltage[i];
-                    if(err_voltage[i] < err_min_val) err_min_val = err_voltage[i];
-                }
-                fwrite(err_voltage, sizeof(double), ERR_SIGNAL_ARRAY_SIZE, err_file);
-                has_new_err_signal = true;
-            }
+        if(ready <= 0) {
+            if(ready < 0 && errno != EINTR) perror("poll error");
+            continue;
+        }
 
-            pthread_mutex_lock(&io_mutex);
-            ongoing_io_count--;
-            pthread_cond_signal(&io_cond); // 通知等待线程
-            pthread_mutex_unlock(&io_mutex);
+        size_t space;
+        uint8_t * dst = rpmsg_decoder_space(&rx_decoder, &space);
+        ssize_t n     = read(rpmsg_fd, dst, space);
+        if(n <= 0) {
+            if(n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) continue;
+            if(n == 0)
+                printf("Connection closed\n");
+            else
+                perror("Read error");
+            break;
+        }
+
+        rpmsg_decoder_commit(&rx_decoder, (size_t)n, on_rpmsg_msg, NULL);
 
-            memmove(recv_buffer, recv_buffer + pkt_size, bytes_received - pkt_size);
-            bytes_received -= pkt_size;
+        rpmsg_rx_stats stats;
+        rpmsg_decoder_get_stats(&rx_decoder, &stats);
+        if(stats.resyncs != resyncs) {
+            printf("WARNING: rpmsg stream misaligned, %u bytes skipped in total\n", stats.resync_bytes);
+            resyncs = stats.resyncs;
+        }
+        if(stats.crc_errors != crc_errors) {
+            printf("WARNING: rpmsg CRC mismatch, %u corrupted frames in total\n", stats.crc_errors);
+            crc_errors = stats.crc_errors;
         }
     }
 
     return NULL;
 }
 
+// 读取非负整数环境变量, 未设置或不合法(非数字、负数、超过max)时返回false, value不变
+static bool env_ulong(const char * name, unsigned long max, unsigned long * value)
+{
+    const char * text = getenv(name);
+    unsigned long parsed;
+    char * end;
+
+    if(text == NULL) return false;
+    errno  = 0;
+    parsed = strtoul(text, &end, 10);
+    if(errno != 0 || end == text || *end != '\0' || strchr(text, '-') != NULL || parsed > max) {
+        printf("Ignoring %s=%s, expected 0 ~ %lu\n", name, text, max);
+        return false;
+    }
+    *value = parsed;
+    return true;
+}
+
+static void self_check_cb(const rpmsg_msg * msg, void * user_data)
+{
+    *(bool *)user_data = msg->msg_type == MSG_MULTI_ARRAY && rpmsg_length_valid(msg->msg_type, msg->length);
+}
+
+// 启动自检: 全部通道满帧长的多通道帧是最长的消息, 须能完整通过解码器
+static bool rpmsg_self_check(void)
+{
+    static uint8_t frame[RPMSG_FRAME_MAX];
+    static int16_t samples[SENSOR_MAX_SAMPLES * SENSOR_MAX_CHANNELS];
+    static rpmsg_decoder decoder;
+    MultiArrayHeader hdr = {.channel_mask = (1u << SENSOR_MAX_CHANNELS) - 1, .samples = SENSOR_MAX_SAMPLES};
+    bool decoded         = false;
+    size_t len = rpmsg_pack_MULTI_ARRAY(frame, sizeof(frame), true, &hdr, samples, sizeof(samples), 0, rpmsg_now_us());
+
+    rpmsg_decoder_init(&decoder);
+    return len > 0 && rpmsg_decoder_feed(&decoder, frame, len, self_check_cb, &decoded) == 1 && decoded;
+}
+
 int start_rpmsg(void)
 {
+    unsigned long samples = 0;
+    unsigned long rate    = 0;
+
+    pthread_once(&rx_dispatcher_once, rx_dispatcher_init);
+    rpmsg_decoder_init(&rx_decoder);
+    printf("rpmsg CRC-32C: %s\n", crc32c_impl());
+    if(!rpmsg_self_check()) {
+        fprintf(stderr, "rpmsg self-check failed: a full-width multi-channel frame does not pass the decoder\n");
+        return EXIT_FAILURE;
+    }
+    // 设置ANC_CRC_BENCH后测量单帧校验耗时(v2帧头 + 一帧采样数组)
+    if(getenv("ANC_CRC_BENCH") != NULL) {
+        crc32c_benchmark(sizeof(rpmsg_header_v2) + atomic_load(&stream_frame_samples) * sizeof(int16_t), 100000);
+    }
+
+    // 握手请求的帧长/采样率可由环境变量覆盖, 先检查范围再收窄, 未设置时为0, 即沿用实时端当前值
+    if(env_ulong("ANC_FRAME_SAMPLES", SENSOR_MAX_SAMPLES, &samples)) stream_hello.frame_samples = (uint16_t)samples;
+    if(env_ulong("ANC_SAMPLE_RATE", UINT32_MAX, &rate)) stream_hello.sample_rate = (uint32_t)rate;
+
     // 打开rpmsg设备
     rpmsg_fd = open(MSG_PATH, O_RDWR | O_NONBLOCK | O_NOCTTY);
     if(rpmsg_fd < 0) {
@@ -362,16 +740,17 @@ int start_rpmsg(void)
         printf("TTY raw mode configured successfully\n");
     }
 
-    pthread_t cmd_send_thread, print_thread;
+    pthread_t cmd_send_thread, print_thread, logger_thread;
+    frame_sub_t * logger_sub = frame_bus_subscribe(FRAME_MASK_ALL, LOGGER_QUEUE_DEPTH, FRAME_DROP_NEWEST);
 
-    if(pthread_create(&cmd_send_thread, NULL, cmd_send_thread_func, NULL) ||
+    if(logger_sub == NULL || pthread_create(&logger_thread, NULL, frame_logger_thread_func, logger_sub) ||
+       pthread_create(&cmd_send_thread, NULL, cmd_send_thread_func, NULL) ||
        pthread_create(&print_thread, NULL, get_array_thread_func, NULL)) {
         perror("Failed to create threads");
         close(rpmsg_fd);
-        fclose(ref_file);
-        fclose(err_file);
+        rpmsg_fd = -1;
         return EXIT_FAILURE;
     }
 
     return EXIT_SUCCESS;
-}
\ No newline at end of file
+}
@@ -1,6 +1,11 @@
 #ifndef LINUX_MSG_H
 #define LINUX_MSG_H
 
+#include <stddef.h>
+#include <sys/types.h>
+#include "rpmsg_codec.h"
+#include "rpmsg_schema.h"
+
 typedef enum {
     CMD_START_EXCITATION = 1,
     CMD_STOP_EXCITATION  = 2,
@@ -13,8 +18,25 @@ typedef enum {
     QUIT                 = 0
 } cmd;
 
+// 实时端运行状况, 来自MSG_STATUS/MSG_HEARTBEAT/MSG_ERROR
+typedef struct
+{
+    uint32_t state;            // rt_state位组合
+    uint32_t heartbeats;       // 累计收到的心跳数
+    uint32_t errors;           // 累计收到的错误上报数
+    uint32_t last_error;       // 最近一次错误码
+    uint32_t heartbeat_age_ms; // 距最近一次心跳的时间, 未收到过心跳为UINT32_MAX
+} rpmsg_peer_status;
 
 int start_rpmsg(void);
 int send_msg(int cmd_type, u_int16_t param_id, double param_value);
+int get_param(u_int16_t param_id, double * param_value);
+int rpmsg_inject(const void * data, size_t len);
+void rpmsg_get_rx_stats(rpmsg_rx_stats * stats);
+int rpmsg_request_stream(uint16_t frame_samples, uint32_t sample_rate);
+void rpmsg_get_stream(StreamConfig * config);
+int rpmsg_request_coeff(uint32_t ident_id, uint16_t offset);
+int rpmsg_register_handler(uint16_t msg_type, rpmsg_handler handler, void * user_data);
+void rpmsg_get_peer_status(rpmsg_peer_status * status);
 
 #endif // LINUX_MSG_H
\ No newline at end of file
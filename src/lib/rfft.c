@@ -0,0 +1,143 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "rfft.h"
+
+#define RFFT_PI 3.14159265358979323846
+
+// GCC向量扩展, x86上编译为SSE, ARM上编译为NEON
+typedef float v4sf __attribute__((vector_size(16)));
+
+static v4sf load4(const float * p)
+{
+    v4sf v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static void store4(float * p, v4sf v)
+{
+    memcpy(p, &v, sizeof(v));
+}
+
+int rfft_init(rfft_plan * plan, uint32_t n)
+{
+    uint32_t m    = n / 2;
+    uint32_t bits = 0;
+
+    memset(plan, 0, sizeof(*plan));
+    if(n < 8 || (n & (n - 1)) != 0) return -1;
+    while((1u << bits) < m) bits++;
+
+    plan->n        = n;
+    plan->bitrev   = malloc(m * sizeof(uint32_t));
+    plan->tw_re    = malloc(m * sizeof(float));
+    plan->tw_im    = malloc(m * sizeof(float));
+    plan->split_re = malloc((m + 1) * sizeof(float));
+    plan->split_im = malloc((m + 1) * sizeof(float));
+    plan->work_re  = malloc(m * sizeof(float));
+    plan->work_im  = malloc(m * sizeof(float));
+    if(!plan->bitrev || !plan->tw_re || !plan->tw_im || !plan->split_re || !plan->split_im || !plan->work_re ||
+       !plan->work_im) {
+        perror("FFT plan allocation failed");
+        rfft_free(plan);
+        return -1;
+    }
+
+    for(uint32_t i = 0; i < m; i++) {
+        uint32_t r = 0;
+        for(uint32_t b = 0; b < bits; b++) r |= ((i >> b) & 1u) << (bits - 1 - b);
+        plan->bitrev[i] = r;
+    }
+
+    // 半长为h的一级使用 e^(-2πij/2h), j = 0 .. h-1, 存放在偏移h-1处
+    for(uint32_t h = 1; h < m; h <<= 1) {
+        for(uint32_t j = 0; j < h; j++) {
+            plan->tw_re[h - 1 + j] = (float)cos(-RFFT_PI * j / h);
+            plan->tw_im[h - 1 + j] = (float)sin(-RFFT_PI * j / h);
+        }
+    }
+
+    for(uint32_t k = 0; k <= m; k++) {
+        plan->split_re[k] = (float)cos(-2.0 * RFFT_PI * k / n);
+        plan->split_im[k] = (float)sin(-2.0 * RFFT_PI * k / n);
+    }
+
+    return 0;
+}
+
+void rfft_free(rfft_plan * plan)
+{
+    free(plan->bitrev);
+    free(plan->tw_re);
+    free(plan->tw_im);
+    free(plan->split_re);
+    free(plan->split_im);
+    free(plan->work_re);
+    free(plan->work_im);
+    memset(plan, 0, sizeof(*plan));
+}
+
+// 一级蝶形, 半长h >= 4时每次处理4个蝶形
+static void butterfly_stage(float * restrict re, float * restrict im, const float * restrict wr,
+                            const float * restrict wi, uint32_t m, uint32_t h)
+{
+    for(uint32_t base = 0; base < m; base += 2 * h) {
+        float * ar = re + base;
+        float * ai = im + base;
+        float * br = ar + h;
+        float * bi = ai + h;
+
+        if(h >= 4) {
+            for(uint32_t j = 0; j < h; j += 4) {
+                v4sf xr = load4(br + j), xi = load4(bi + j);
+                v4sf cr = load4(wr + j), ci = load4(wi + j);
+                v4sf tr = xr * cr - xi * ci;
+                v4sf ti = xr * ci + xi * cr;
+                v4sf ur = load4(ar + j), ui = load4(ai + j);
+                store4(ar + j, ur + tr);
+                store4(ai + j, ui + ti);
+                store4(br + j, ur - tr);
+                store4(bi + j, ui - ti);
+            }
+        } else {
+            for(uint32_t j = 0; j < h; j++) {
+                float tr = br[j] * wr[j] - bi[j] * wi[j];
+                float ti = br[j] * wi[j] + bi[j] * wr[j];
+                br[j]    = ar[j] - tr;
+                bi[j]    = ai[j] - ti;
+                ar[j] += tr;
+                ai[j] += ti;
+            }
+        }
+    }
+}
+
+void rfft_forward(rfft_plan * plan, const float * in, float * out_re, float * out_im)
+{
+    uint32_t m = plan->n / 2;
+    float * re = plan->work_re;
+    float * im = plan->work_im;
+
+    // 偶数点作实部, 奇数点作虚部, 同时完成位反转重排
+    for(uint32_t i = 0; i < m; i++) {
+        uint32_t r = plan->bitrev[i];
+        re[r]      = in[2 * i];
+        im[r]      = in[2 * i + 1];
+    }
+
+    for(uint32_t h = 1; h < m; h <<= 1) butterfly_stage(re, im, plan->tw_re + h - 1, plan->tw_im + h - 1, m, h);
+
+    // 拆分: 偶部E = (Z[k] + Z*[m-k]) / 2, 奇部O = (Z[k] - Z*[m-k]) / 2i, X[k] = E + W^k·O
+    for(uint32_t k = 0; k <= m; k++) {
+        uint32_t a = k == m ? 0 : k;
+        uint32_t b = k == 0 ? 0 : m - k;
+        float er   = 0.5f * (re[a] + re[b]);
+        float ei   = 0.5f * (im[a] - im[b]);
+        float orr  = 0.5f * (im[a] + im[b]);
+        float oi   = -0.5f * (re[a] - re[b]);
+        out_re[k]  = er + orr * plan->split_re[k] - oi * plan->split_im[k];
+        out_im[k]  = ei + orr * plan->split_im[k] + oi * plan->split_re[k];
+    }
+}
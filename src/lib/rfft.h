@@ -0,0 +1,25 @@
+#ifndef RFFT_H
+#define RFFT_H
+
+#include <stdint.h>
+
+// 实数FFT: n点实数序列按n/2点复数FFT计算后拆分, 复数部分为基2迭代实现
+// 所有表和工作缓冲区在rfft_init中一次性分配, rfft_forward不再分配内存
+typedef struct
+{
+    uint32_t n;        // 实数点数, 2的幂, >= 8
+    uint32_t * bitrev; // n/2点位反转表
+    float * tw_re;     // 各级蝶形的旋转因子按级连续存放, 共n/2 - 1个
+    float * tw_im;
+    float * split_re; // 拆分用旋转因子 e^(-2πik/n), k = 0 .. n/2
+    float * split_im;
+    float * work_re; // n/2点复数工作区, 实部/虚部分开存放便于向量化
+    float * work_im;
+} rfft_plan;
+
+int rfft_init(rfft_plan * plan, uint32_t n);
+void rfft_free(rfft_plan * plan);
+// in为n个实数, 输出n/2 + 1个频点(直流到奈奎斯特)
+void rfft_forward(rfft_plan * plan, const float * in, float * out_re, float * out_im);
+
+#endif // RFFT_H
@@ -0,0 +1,186 @@
+#include <stdio.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include "crc32c.h"
+#include "rpmsg_codec.h"
+
+#define V1_PACKET_SIZE (sizeof(uint16_t) + sizeof(SensorArray))
+#define V2_MAGIC_LO (RPMSG_V2_MAGIC & 0xFF)
+#define V2_MAGIC_HI (RPMSG_V2_MAGIC >> 8)
+#define V2_CRC_SPAN offsetof(rpmsg_header_v2, crc) // 帧头中参与CRC计算的字节数
+#define SEQ_GAP_MAX 4096 // 序号前跳超过此值或后退视为对端重启, 重新同步序号而不计丢帧
+
+uint64_t rpmsg_now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+static bool is_v1_type(uint16_t msg_type)
+{
+    return msg_type == MSG_REF_ARRAY || msg_type == MSG_ERR_ARRAY;
+}
+
+// 可能的帧起始字节: v2魔数低字节, 以及未锁定v2时的v1消息类型低字节
+static bool is_sync_byte(const rpmsg_decoder * dec, uint8_t byte)
+{
+    if(byte == V2_MAGIC_LO) return true;
+    return !dec->v2_seen && (byte == (MSG_REF_ARRAY & 0xFF) || byte == (MSG_ERR_ARRAY & 0xFF));
+}
+
+static uint32_t v2_crc(const rpmsg_header_v2 * hdr, const uint8_t * payload)
+{
+    uint32_t crc = crc32c_update(CRC32C_INIT, hdr, V2_CRC_SPAN);
+    return CRC32C_FINAL(crc32c_update(crc, payload, hdr->length));
+}
+
+// 从当前位置之后寻找下一个可能的帧起点, 每字节只检查一次
+static void resync(rpmsg_decoder * dec)
+{
+    size_t pos = dec->start + 1;
+
+    while(pos < dec->end && !is_sync_byte(dec, dec->buf[pos])) pos++;
+
+    atomic_fetch_add_explicit(&dec->resyncs, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&dec->resync_bytes, (unsigned int)(pos - dec->start), memory_order_relaxed);
+    dec->start = pos;
+}
+
+void rpmsg_decoder_init(rpmsg_decoder * dec)
+{
+    dec->start     = 0;
+    dec->end       = 0;
+    dec->v2_seen   = false;
+    dec->seq_valid = false;
+    dec->next_seq  = 0;
+    atomic_init(&dec->frames, 0);
+    atomic_init(&dec->lost, 0);
+    atomic_init(&dec->resyncs, 0);
+    atomic_init(&dec->resync_bytes, 0);
+    atomic_init(&dec->crc_errors, 0);
+}
+
+uint8_t * rpmsg_decoder_space(rpmsg_decoder * dec, size_t * space)
+{
+    *space = sizeof(dec->buf) - dec->end;
+    return dec->buf + dec->end;
+}
+
+int rpmsg_decoder_commit(rpmsg_decoder * dec, size_t len, rpmsg_msg_cb cb, void * user_data)
+{
+    int count = 0;
+
+    dec->end += len;
+
+    while(dec->end - dec->start >= sizeof(uint16_t)) {
+        const uint8_t * p = dec->buf + dec->start;
+        size_t avail      = dec->end - dec->start;
+        rpmsg_msg msg;
+
+        if(p[0] == V2_MAGIC_LO && p[1] == V2_MAGIC_HI) {
+            rpmsg_header_v2 hdr;
+
+            if(avail < sizeof(hdr)) break;
+            memcpy(&hdr, p, sizeof(hdr));
+            // 版本或长度不合理说明魔数是负载中的巧合, 直接重同步
+            if(hdr.version != RPMSG_V2_VERSION || hdr.length > RPMSG_MAX_PAYLOAD) {
+                resync(dec);
+                continue;
+            }
+            if(avail < sizeof(hdr) + hdr.length) break;
+            if(v2_crc(&hdr, p + sizeof(hdr)) != hdr.crc) {
+                atomic_fetch_add_explicit(&dec->crc_errors, 1, memory_order_relaxed);
+                resync(dec);
+                continue;
+            }
+
+            // 序号不连续即丢帧, O(1)得出丢失数量; 后退时无符号差值回绕为极大值, 同样按重启处理
+            if(dec->seq_valid && hdr.seq != dec->next_seq) {
+                uint32_t gap = hdr.seq - dec->next_seq;
+                if(gap <= SEQ_GAP_MAX) atomic_fetch_add_explicit(&dec->lost, gap, memory_order_relaxed);
+            }
+            dec->seq_valid = true;
+            dec->next_seq  = hdr.seq + 1;
+            dec->v2_seen   = true;
+
+            msg.version      = RPMSG_V2_VERSION;
+            msg.msg_type     = hdr.msg_type;
+            msg.length       = hdr.length;
+            msg.seq          = hdr.seq;
+            msg.timestamp_us = hdr.timestamp_us;
+            msg.payload      = p + sizeof(hdr);
+            dec->start += sizeof(hdr) + hdr.length;
+        } else {
+            uint16_t msg_type;
+
+            memcpy(&msg_type, p, sizeof(msg_type));
+            if(dec->v2_seen || !is_v1_type(msg_type)) {
+                resync(dec);
+                continue;
+            }
+            if(avail < V1_PACKET_SIZE) break;
+
+            msg.version      = 1;
+            msg.msg_type     = msg_type;
+            msg.length       = sizeof(SensorArray);
+            msg.seq          = 0;
+            msg.timestamp_us = rpmsg_now_us();
+            msg.payload      = p + sizeof(msg_type);
+            dec->start += V1_PACKET_SIZE;
+        }
+
+        atomic_fetch_add_explicit(&dec->frames, 1, memory_order_relaxed);
+        cb(&msg, user_data);
+        count++;
+    }
+
+    // 每次提交只搬移一次剩余数据
+    if(dec->start > 0) {
+        memmove(dec->buf, dec->buf + dec->start, dec->end - dec->start);
+        dec->end -= dec->start;
+        dec->start = 0;
+    }
+
+    return count;
+}
+
+int rpmsg_decoder_feed(rpmsg_decoder * dec, const void * data, size_t len, rpmsg_msg_cb cb, void * user_data)
+{
+    size_t space;
+    uint8_t * dst = rpmsg_decoder_space(dec, &space);
+
+    if(len > space) return -1;
+    memcpy(dst, data, len);
+    return rpmsg_decoder_commit(dec, len, cb, user_data);
+}
+
+void rpmsg_decoder_get_stats(const rpmsg_decoder * dec, rpmsg_rx_stats * stats)
+{
+    stats->frames       = atomic_load_explicit(&dec->frames, memory_order_relaxed);
+    stats->lost         = atomic_load_explicit(&dec->lost, memory_order_relaxed);
+    stats->resyncs      = atomic_load_explicit(&dec->resyncs, memory_order_relaxed);
+    stats->resync_bytes = atomic_load_explicit(&dec->resync_bytes, memory_order_relaxed);
+    stats->crc_errors   = atomic_load_explicit(&dec->crc_errors, memory_order_relaxed);
+}
+
+size_t rpmsg_encode_v2(uint8_t * out, uint16_t msg_type, const void * payload, uint16_t length, uint32_t seq,
+                       uint64_t timestamp_us)
+{
+    rpmsg_header_v2 hdr = {.magic        = RPMSG_V2_MAGIC,
+                           .version      = RPMSG_V2_VERSION,
+                           .flags        = 0,
+                           .msg_type     = msg_type,
+                           .length       = length,
+                           .seq          = seq,
+                           .timestamp_us = timestamp_us};
+
+    hdr.crc = v2_crc(&hdr, payload);
+    memcpy(out, &hdr, sizeof(hdr));
+    if(payload != out + sizeof(hdr)) memcpy(out + sizeof(hdr), payload, length);
+
+    return sizeof(hdr) + length;
+}
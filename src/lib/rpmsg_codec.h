@@ -0,0 +1,62 @@
+#ifndef RPMSG_CODEC_H
+#define RPMSG_CODEC_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include "rpmsg_protocol.h"
+
+// 解码出的一条消息, payload指向解码器内部缓冲区, 仅在回调期间有效
+typedef struct
+{
+    uint8_t version;       // 1 或 2
+    uint16_t msg_type;     // 消息类型
+    uint16_t length;       // 负载字节数
+    uint32_t seq;          // 发送序号, v1固定为0
+    uint64_t timestamp_us; // 采样时刻, v1取接收时刻(CLOCK_MONOTONIC)
+    const uint8_t * payload;
+} rpmsg_msg;
+
+typedef struct
+{
+    uint32_t frames;       // 成功解码的消息数
+    uint32_t lost;         // 按序号推算的丢失消息数
+    uint32_t resyncs;      // 错位重同步次数
+    uint32_t resync_bytes; // 重同步跳过的字节数
+    uint32_t crc_errors;   // CRC校验失败次数
+} rpmsg_rx_stats;
+
+typedef void (*rpmsg_msg_cb)(const rpmsg_msg * msg, void * user_data);
+
+typedef struct
+{
+    uint8_t buf[2 * (sizeof(rpmsg_header_v2) + RPMSG_MAX_PAYLOAD)];
+    size_t start; // 未解析数据起点
+    size_t end;   // 未解析数据终点
+    bool v2_seen; // 收到过v2帧后不再按v1解析, 避免在负载中误同步
+    bool seq_valid;
+    uint32_t next_seq;
+    // 计数器由解码线程更新, 其他线程可随时读取
+    atomic_uint frames;
+    atomic_uint lost;
+    atomic_uint resyncs;
+    atomic_uint resync_bytes;
+    atomic_uint crc_errors;
+} rpmsg_decoder;
+
+void rpmsg_decoder_init(rpmsg_decoder * dec);
+// 取得可直接read()写入的空闲区, 写入后调用rpmsg_decoder_commit解析
+uint8_t * rpmsg_decoder_space(rpmsg_decoder * dec, size_t * space);
+int rpmsg_decoder_commit(rpmsg_decoder * dec, size_t len, rpmsg_msg_cb cb, void * user_data);
+int rpmsg_decoder_feed(rpmsg_decoder * dec, const void * data, size_t len, rpmsg_msg_cb cb, void * user_data);
+void rpmsg_decoder_get_stats(const rpmsg_decoder * dec, rpmsg_rx_stats * stats);
+
+// 按v2格式封装一条消息, out至少为sizeof(rpmsg_header_v2) + length字节, 返回总长度
+// payload可以已经位于out + sizeof(rpmsg_header_v2), 此时不再复制
+size_t rpmsg_encode_v2(uint8_t * out, uint16_t msg_type, const void * payload, uint16_t length, uint32_t seq,
+                       uint64_t timestamp_us);
+
+uint64_t rpmsg_now_us(void);
+
+#endif // RPMSG_CODEC_H
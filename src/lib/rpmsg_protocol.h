@@ -15,10 +15,19 @@ typedef enum {
 
 // ϢͶ (˫)
 typedef enum {
-    MSG_COMMAND   = 0xA1, // Linux->ʵʱ: ָ
-    MSG_SET_PARAM = 0xB1, // Linux->ʵʱ: 
-    MSG_REF_ARRAY = 0xC1, // ʵʱ->Linux: οź
-    MSG_ERR_ARRAY = 0xC2  // ʵʱ->Linux: ź
+    MSG_COMMAND       = 0xA1, // Linux->ʵʱ: ָ
+    MSG_SET_PARAM     = 0xB1, // Linux->ʵʱ: 
+    MSG_REF_ARRAY     = 0xC1, // ʵʱ->Linux: οź
+    MSG_ERR_ARRAY     = 0xC2, // ʵʱ->Linux: ź
+    MSG_MULTI_ARRAY   = 0xC3, // ʵʱ->Linux: ͨ֯(v2)
+    MSG_STREAM_HELLO  = 0xD1, // Linux->ʵʱ: ֡(v2)
+    MSG_STREAM_CONFIG = 0xD2, // ʵʱ->Linux: ʵЧ֡(v2)
+    MSG_STATUS        = 0xE1, // ʵʱ->Linux: ״̬, ״̬仯ʱ(v2)
+    MSG_HEARTBEAT     = 0xE2, // ʵʱ->Linux: , RPMSG_HEARTBEAT_PERIOD_MS(v2)
+    MSG_LOG           = 0xE3, // ʵʱ->Linux: ı־(v2)
+    MSG_ERROR         = 0xE4, // ʵʱ->Linux: ϱ(v2)
+    MSG_SP_COEFF      = 0xF1, // ʵʱ->Linux: μͨʶϵֿ(v2)
+    MSG_COEFF_REQUEST = 0xF2  // Linux->ʵʱ: طʶϵ(v2)
 } msg_Type;
 
 typedef enum {
@@ -35,9 +44,118 @@ typedef struct
 } ParamPayload;
 
 // 鸺ؽṹ
+// v1̶ΪSensorArray; v2Ϊint16,  = ֡ͷlength / 2, Э
 #define REF_SIGNAL_ARRAY_SIZE 200
 #define ERR_SIGNAL_ARRAY_SIZE 200
+#define SENSOR_MAX_SAMPLES 1024 // v2֡
 typedef uint16_t SensorArray[REF_SIGNAL_ARRAY_SIZE];
+
+// ͨ: ο/źŹ̶Ϊ0/1, ͨϢͨ֡ͬһ
+#define SENSOR_MAX_CHANNELS 16
+#define SENSOR_CH_REF 0
+#define SENSOR_CH_ERR 1
+
+// ͨ: MultiArrayHeader + int16[samples][ͨ]
+// 㽻֯, ͬһڰͨ, һݰһȫͨ
+typedef struct
+{
+    uint32_t channel_mask; // bit n λʾͨn, n < SENSOR_MAX_CHANNELS
+    uint16_t samples;      // ÿͨ, 1 ~ SENSOR_MAX_SAMPLES
+    uint16_t reserved;     // 0
+} MultiArrayHeader;
+
+// , MSG_STREAM_HELLOMSG_STREAM_CONFIG
+// HELLOֶΪ0ʾʵʱ˵ǰֵ, CONFIGΪʵЧֵ
+typedef struct
+{
+    uint16_t frame_samples; // ÿ֡, 1 ~ SENSOR_MAX_SAMPLES
+    uint16_t reserved;      // 0
+    uint32_t sample_rate;   // , Hz
+} StreamConfig;
+
+// ʵʱ״̬λ
+typedef enum {
+    RT_STATE_EXCITATION = 0x01, // 
+    RT_STATE_CONTROL    = 0x02, // 
+    RT_STATE_IDENTIFY   = 0x04, // μͨʶ
+    RT_STATE_DAMPING    = 0x08, // 
+    RT_STATE_FAULT      = 0x80  // , MSG_ERROR
+} rt_state;
+
+typedef struct
+{
+    uint32_t state;     // rt_stateλ
+    uint32_t uptime_ms; // ʵʱϵʱ
+    uint16_t cpu_load;  // ʵʱ˸, ǧֱ
+    uint16_t reserved;  // 0
+} StatusPayload;
+
+#define RPMSG_HEARTBEAT_PERIOD_MS 1000
+typedef struct
+{
+    uint32_t counter;   // , ÿμ1
+    uint32_t uptime_ms; // ʵʱϵʱ
+} HeartbeatPayload;
+
+// ־: LogHeader + ı(β'\0')
+typedef enum {
+    RT_LOG_ERROR = 0,
+    RT_LOG_WARN  = 1,
+    RT_LOG_INFO  = 2,
+    RT_LOG_DEBUG = 3
+} rt_log_level;
+
+typedef struct
+{
+    uint8_t level;    // rt_log_level
+    uint8_t reserved; // 0
+} LogHeader;
+
+typedef struct
+{
+    uint16_t code;     // , ʵʱ˶
+    uint16_t reserved; // 0
+    uint32_t detail;   // Ϣ
+} ErrorPayload;
+
+// μͨʶϵ: CoeffChunkHeader + float[n], ϵڵ֡ʱoffsetֿ鷢
+// ͬһαʶĸident_idͬ, Linuxఴoffset˳ƴ, ȱʱMSG_COEFF_REQUESTȱڴط
+#define SP_COEFF_MAX_TAPS 1024
+typedef struct
+{
+    uint32_t ident_id;    // ʶ, ÿһαʶ1
+    uint32_t sample_rate; // ʶʱĲ, Hz
+    uint16_t total;       // ϵ, 1 ~ SP_COEFF_MAX_TAPS
+    uint16_t offset;      // ׸ϵ
+} CoeffChunkHeader;
+
+typedef struct
+{
+    uint32_t ident_id; // 0ʾһαʶ
+    uint16_t offset;   // Ӹϵʼط
+    uint16_t reserved; // 0
+} CoeffRequest;
+#pragma pack(pop)
+
+// v2֡ͷ: ħ + 汾 +  +  + ʱ + CRC, ؽ֡ͷ֮
+// v1ݰֻmsg_type͸, Linuxౣv1Լݾɹ̼
+#define RPMSG_V2_MAGIC 0x5AA5
+#define RPMSG_V2_VERSION 2
+// س, Ϊ֡ͷλ; Ϣ, ȫͨ֡Ķͨȷ
+#define RPMSG_MAX_PAYLOAD (sizeof(MultiArrayHeader) + SENSOR_MAX_CHANNELS * SENSOR_MAX_SAMPLES * sizeof(int16_t))
+
+#pragma pack(push, 1)
+typedef struct
+{
+    uint16_t magic;        // RPMSG_V2_MAGIC
+    uint8_t version;       // RPMSG_V2_VERSION
+    uint8_t flags;         // , 0
+    uint16_t msg_type;     // Ϣ
+    uint16_t length;       // ֽ, ֡ͷ
+    uint32_t seq;          // , ÿϢ1, ڶ֡
+    uint64_t timestamp_us; // ׸Ĳʱ(Ͷʱ, ΢)
+    uint32_t crc;          // CRC-32C, ֡ͷ(ֶ)͸
+} rpmsg_header_v2;
 #pragma pack(pop)
 
 // ݰͨýṹ
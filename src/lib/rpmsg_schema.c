@@ -0,0 +1,110 @@
+#include <stdio.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "rpmsg_schema.h"
+
+// 各消息类型的负载布局, 由消息表生成, 表中没有的类型present为false
+typedef struct
+{
+    bool present;
+    uint8_t kind;
+    uint16_t elem_size;
+    uint16_t max_count;
+} rpmsg_layout;
+
+static const rpmsg_layout layouts[RPMSG_TYPE_COUNT] = {
+#define RPMSG_X_LAYOUT(name, id, type, form, wire_size, limit)                                                         \
+    [id] = {.present = true, .kind = form, .elem_size = sizeof(type), .max_count = limit},
+    RPMSG_SCHEMA(RPMSG_X_LAYOUT)
+#undef RPMSG_X_LAYOUT
+};
+
+// 布局表的指定初始化遇到重复类型时后一行静默覆盖, 这里为每行生成一个case标签, 重复则编译失败
+// 仅供编译期检查, 运行时不调用
+static inline void schema_check_unique(uint16_t msg_type)
+{
+    switch(msg_type) {
+#define RPMSG_X_CASE(name, id, type, form, wire_size, limit) case id:
+        RPMSG_SCHEMA(RPMSG_X_CASE)
+#undef RPMSG_X_CASE
+        default: break;
+    }
+}
+
+// 查表取得消息表中类型的布局, 不在表中返回NULL
+static const rpmsg_layout * layout_get(uint16_t msg_type)
+{
+    if(msg_type >= RPMSG_TYPE_COUNT || !layouts[msg_type].present) return NULL;
+    return &layouts[msg_type];
+}
+
+static bool length_matches(const rpmsg_layout * layout, uint16_t length)
+{
+    switch(layout->kind) {
+        case RPMSG_FIXED: return length == layout->elem_size;
+        case RPMSG_ARRAY:
+            return length > 0 && length % layout->elem_size == 0 && length / layout->elem_size <= layout->max_count;
+        default: return length >= layout->elem_size;
+    }
+}
+
+bool rpmsg_length_valid(uint16_t msg_type, uint16_t length)
+{
+    const rpmsg_layout * layout = layout_get(msg_type);
+
+    return layout != NULL && length_matches(layout, length);
+}
+
+void rpmsg_dispatcher_init(rpmsg_dispatcher * dispatcher)
+{
+    memset(dispatcher, 0, sizeof(*dispatcher));
+}
+
+int rpmsg_dispatcher_register(rpmsg_dispatcher * dispatcher, uint16_t msg_type, rpmsg_handler handler,
+                              void * user_data)
+{
+    if(layout_get(msg_type) == NULL) {
+        printf("rpmsg: message type 0x%04X is not in the schema\n", msg_type);
+        return -1;
+    }
+
+    dispatcher->routes[msg_type].handler   = handler;
+    dispatcher->routes[msg_type].user_data = user_data;
+
+    return 0;
+}
+
+// 查表分发, 不随消息种类增多而增加分支
+rpmsg_dispatch_result rpmsg_dispatch(const rpmsg_dispatcher * dispatcher, const rpmsg_msg * msg)
+{
+    const rpmsg_layout * layout = layout_get(msg->msg_type);
+    const rpmsg_route * route;
+
+    if(layout == NULL) return RPMSG_DISPATCH_UNKNOWN;
+    if(!length_matches(layout, msg->length)) return RPMSG_DISPATCH_BAD_LEN;
+
+    route = &dispatcher->routes[msg->msg_type];
+    if(route->handler == NULL) return RPMSG_DISPATCH_UNHANDLED;
+    route->handler(msg, route->user_data);
+
+    return RPMSG_DISPATCH_OK;
+}
+
+size_t rpmsg_pack(uint8_t * out, size_t out_size, bool v2, uint16_t msg_type, const void * head, size_t head_len,
+                  const void * tail, size_t tail_len, uint32_t seq, uint64_t timestamp_us)
+{
+    size_t offset = v2 ? sizeof(rpmsg_header_v2) : sizeof(msg_type);
+    size_t length = head_len + tail_len;
+
+    if(length > RPMSG_MAX_PAYLOAD || tail_len > RPMSG_MAX_PAYLOAD || offset + length > out_size) return 0;
+
+    // 两段负载先拼到消息体的位置, v2再在其前面写入帧头
+    memcpy(out + offset, head, head_len);
+    if(tail_len > 0) memcpy(out + offset + head_len, tail, tail_len);
+    if(v2) return rpmsg_encode_v2(out, msg_type, out + offset, (uint16_t)length, seq, timestamp_us);
+
+    memcpy(out, &msg_type, sizeof(msg_type));
+    return offset + length;
+}
@@ -0,0 +1,136 @@
+#ifndef RPMSG_SCHEMA_H
+#define RPMSG_SCHEMA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "rpmsg_protocol.h"
+#include "rpmsg_codec.h"
+
+// 负载形式
+#define RPMSG_FIXED 0  // 负载恰为一个负载类型
+#define RPMSG_ARRAY 1  // 负载为负载类型数组, 1 ~ 上限个元素
+#define RPMSG_HEADER 2 // 负载以负载类型开头, 其后的变长部分由处理函数校验
+
+// 消息表: 新增消息只需在此加一行, 打包函数/长度校验/分发表均由此生成
+// X(名称, 消息类型, 负载类型, 负载形式, 负载类型线上字节数, 元素上限)
+// 线上字节数须与实时端一致, 不一致时编译失败
+#define RPMSG_SCHEMA(X)                                                                                                \
+    X(COMMAND, MSG_COMMAND, uint16_t, RPMSG_FIXED, 2, 1)                                                               \
+    X(SET_PARAM, MSG_SET_PARAM, ParamPayload, RPMSG_FIXED, 10, 1)                                                      \
+    X(REF_ARRAY, MSG_REF_ARRAY, int16_t, RPMSG_ARRAY, 2, SENSOR_MAX_SAMPLES)                                           \
+    X(ERR_ARRAY, MSG_ERR_ARRAY, int16_t, RPMSG_ARRAY, 2, SENSOR_MAX_SAMPLES)                                           \
+    X(MULTI_ARRAY, MSG_MULTI_ARRAY, MultiArrayHeader, RPMSG_HEADER, 8, 1)                                              \
+    X(STREAM_HELLO, MSG_STREAM_HELLO, StreamConfig, RPMSG_FIXED, 8, 1)                                                 \
+    X(STREAM_CONFIG, MSG_STREAM_CONFIG, StreamConfig, RPMSG_FIXED, 8, 1)                                               \
+    X(STATUS, MSG_STATUS, StatusPayload, RPMSG_FIXED, 12, 1)                                                           \
+    X(HEARTBEAT, MSG_HEARTBEAT, HeartbeatPayload, RPMSG_FIXED, 8, 1)                                                   \
+    X(LOG, MSG_LOG, LogHeader, RPMSG_HEADER, 2, 1)                                                                     \
+    X(ERROR, MSG_ERROR, ErrorPayload, RPMSG_FIXED, 8, 1)                                                               \
+    X(SP_COEFF, MSG_SP_COEFF, CoeffChunkHeader, RPMSG_HEADER, 12, 1)                                                   \
+    X(COEFF_REQUEST, MSG_COEFF_REQUEST, CoeffRequest, RPMSG_FIXED, 8, 1)
+
+// 消息类型取值范围, 分发表按类型直接索引
+#define RPMSG_TYPE_COUNT 256
+
+// C99下的编译期断言
+#define RPMSG_STATIC_ASSERT(cond, name) typedef char rpmsg_static_assert_##name[(cond) ? 1 : -1]
+
+// 线上字节数与负载类型的sizeof绑定, 类型或表中字节数单方面改动即编译失败; 长度上限按sizeof计算, 与打包/校验一致
+#define RPMSG_X_ASSERT(name, id, type, kind, wire_size, max_count)                                                     \
+    RPMSG_STATIC_ASSERT(sizeof(type) == (wire_size), name##_wire_size);                                                \
+    RPMSG_STATIC_ASSERT(sizeof(type) * (max_count) <= RPMSG_MAX_PAYLOAD, name##_max_payload);                          \
+    RPMSG_STATIC_ASSERT((id) < RPMSG_TYPE_COUNT, name##_type_range);
+RPMSG_SCHEMA(RPMSG_X_ASSERT)
+#undef RPMSG_X_ASSERT
+RPMSG_STATIC_ASSERT(sizeof(rpmsg_header_v2) == 24, header_v2_size);
+// 帧头length为16位; 多通道数组的长度由处理函数校验, 这里保证全部通道满帧长时不被解码器当作错位丢弃
+RPMSG_STATIC_ASSERT(RPMSG_MAX_PAYLOAD <= UINT16_MAX, max_payload_length);
+RPMSG_STATIC_ASSERT(sizeof(MultiArrayHeader) + (size_t)SENSOR_MAX_CHANNELS * SENSOR_MAX_SAMPLES * sizeof(int16_t) <=
+                        RPMSG_MAX_PAYLOAD,
+                    multi_array_full_width);
+
+// 各消息负载类型的字节数: RPMSG_SIZE_COMMAND ...
+enum {
+#define RPMSG_X_SIZE(name, id, type, kind, wire_size, max_count) RPMSG_SIZE_##name = sizeof(type),
+    RPMSG_SCHEMA(RPMSG_X_SIZE)
+#undef RPMSG_X_SIZE
+};
+
+// 定长负载中最大者, 决定发送缓冲区大小
+typedef union
+{
+#define RPMSG_X_MEMBER(name, id, type, kind, wire_size, max_count) type name;
+    RPMSG_SCHEMA(RPMSG_X_MEMBER)
+#undef RPMSG_X_MEMBER
+} rpmsg_any_payload;
+
+#define RPMSG_TX_MAX (sizeof(rpmsg_header_v2) + sizeof(rpmsg_any_payload))
+// 任意消息的最大长度, 数组和带变长尾部的消息按此分配发送缓冲区
+#define RPMSG_FRAME_MAX (sizeof(rpmsg_header_v2) + RPMSG_MAX_PAYLOAD)
+
+// 按v1或v2格式封装到容量为out_size的缓冲区, 负载为定长头部head加变长尾部tail(可为空), 返回总长度
+// 负载超过RPMSG_MAX_PAYLOAD或放不进缓冲区时返回0
+size_t rpmsg_pack(uint8_t * out, size_t out_size, bool v2, uint16_t msg_type, const void * head, size_t head_len,
+                  const void * tail, size_t tail_len, uint32_t seq, uint64_t timestamp_us);
+
+// 带类型的打包函数, 负载类型不符时编译报警, 按负载形式生成不同参数:
+// 定长:   rpmsg_pack_COMMAND(out, v2, &command, seq, ts), out至少RPMSG_TX_MAX字节, 长度在编译期确定
+// 数组:   rpmsg_pack_REF_ARRAY(out, out_size, v2, samples, count, seq, ts), count为1 ~ 元素上限
+// 带尾部: rpmsg_pack_LOG(out, out_size, v2, &header, tail, tail_len, seq, ts)
+// 参数不合法或放不进缓冲区时返回0
+#define RPMSG_PACK_RPMSG_FIXED(name, id, type, max_count)                                                              \
+    static inline size_t rpmsg_pack_##name(uint8_t * out, bool v2, const type * payload, uint32_t seq,                \
+                                           uint64_t timestamp_us)                                                      \
+    {                                                                                                                  \
+        return rpmsg_pack(out, RPMSG_TX_MAX, v2, id, payload, sizeof(type), NULL, 0, seq, timestamp_us);               \
+    }
+#define RPMSG_PACK_RPMSG_ARRAY(name, id, type, max_count)                                                              \
+    static inline size_t rpmsg_pack_##name(uint8_t * out, size_t out_size, bool v2, const type * payload,             \
+                                           size_t count, uint32_t seq, uint64_t timestamp_us)                          \
+    {                                                                                                                  \
+        if(count == 0 || count > (max_count)) return 0;                                                                \
+        return rpmsg_pack(out, out_size, v2, id, payload, count * sizeof(type), NULL, 0, seq, timestamp_us);           \
+    }
+#define RPMSG_PACK_RPMSG_HEADER(name, id, type, max_count)                                                             \
+    static inline size_t rpmsg_pack_##name(uint8_t * out, size_t out_size, bool v2, const type * header,              \
+                                           const void * tail, size_t tail_len, uint32_t seq, uint64_t timestamp_us)    \
+    {                                                                                                                  \
+        return rpmsg_pack(out, out_size, v2, id, header, sizeof(type), tail, tail_len, seq, timestamp_us);             \
+    }
+#define RPMSG_X_PACK(name, id, type, kind, wire_size, max_count) RPMSG_PACK_##kind(name, id, type, max_count)
+RPMSG_SCHEMA(RPMSG_X_PACK)
+#undef RPMSG_X_PACK
+#undef RPMSG_PACK_RPMSG_FIXED
+#undef RPMSG_PACK_RPMSG_ARRAY
+#undef RPMSG_PACK_RPMSG_HEADER
+
+// 接收分发: 按消息类型直接索引处理函数, 每帧O(1), 与消息种类数无关
+typedef void (*rpmsg_handler)(const rpmsg_msg * msg, void * user_data);
+
+typedef struct
+{
+    rpmsg_handler handler;
+    void * user_data;
+} rpmsg_route;
+
+typedef struct
+{
+    rpmsg_route routes[RPMSG_TYPE_COUNT];
+} rpmsg_dispatcher;
+
+typedef enum {
+    RPMSG_DISPATCH_OK,
+    RPMSG_DISPATCH_UNKNOWN,   // 消息表中没有该类型
+    RPMSG_DISPATCH_BAD_LEN,   // 负载长度与消息表不符
+    RPMSG_DISPATCH_UNHANDLED, // 本端未注册处理函数
+} rpmsg_dispatch_result;
+
+void rpmsg_dispatcher_init(rpmsg_dispatcher * dispatcher);
+// 只能注册消息表中已有的类型, 须在开始接收前完成
+int rpmsg_dispatcher_register(rpmsg_dispatcher * dispatcher, uint16_t msg_type, rpmsg_handler handler,
+                              void * user_data);
+rpmsg_dispatch_result rpmsg_dispatch(const rpmsg_dispatcher * dispatcher, const rpmsg_msg * msg);
+bool rpmsg_length_valid(uint16_t msg_type, uint16_t length);
+
+#endif // RPMSG_SCHEMA_H
@@ -0,0 +1,223 @@
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "scope.h"
+
+// 丢帧后两通道错位, 须清空缓冲重新等待触发, 队列满时丢新帧; 只订阅参考/误差, 每个采样块2帧
+// 每次触发按记录长度累加并搬移缓冲, 与UI线程争用结果锁, 期间到达的采样块在队列中等待, 按16个采样块留余量
+#define SCOPE_QUEUE_DEPTH (2 * 16)
+#define SCOPE_STREAM_LEN (2 * SCOPE_MAX_RECORD + FRAME_MAX_SAMPLES) // 等待触发和记录补齐的缓冲长度
+
+// 配置由UI线程写入, 处理线程每帧检查一次标志
+static pthread_mutex_t config_mutex = PTHREAD_MUTEX_INITIALIZER;
+static scope_config pending_config;
+static atomic_bool config_dirty;
+
+// 以下只由处理线程访问
+static frame_sub_t * scope_sub;
+static scope_config active = {.mode = SCOPE_MODE_RAW};
+static double stream[SCOPE_CHANNELS][SCOPE_STREAM_LEN]; // 两通道按同一采样序号对齐
+static uint32_t stream_fill[SCOPE_CHANNELS];
+static uint32_t search_pos; // 参考通道下一个待检查触发的位置
+static bool armed;
+static uint32_t dropped_seen;
+static scope_trace work; // 累加器, 发布时只拷贝有效长度
+
+static pthread_mutex_t result_mutex = PTHREAD_MUTEX_INITIALIZER;
+static scope_trace result;
+static uint32_t result_generation;
+
+static void stream_reset(void)
+{
+    stream_fill[0] = 0;
+    stream_fill[1] = 0;
+    search_pos     = 0;
+    armed          = false;
+}
+
+// 两通道丢弃相同数量的最旧采样, 保持对齐
+static void stream_discard(uint32_t count)
+{
+    if(count > stream_fill[0]) count = stream_fill[0];
+    if(count > stream_fill[1]) count = stream_fill[1];
+    if(count == 0) return;
+
+    for(int ch = 0; ch < SCOPE_CHANNELS; ch++) {
+        memmove(stream[ch], stream[ch] + count, (stream_fill[ch] - count) * sizeof(double));
+        stream_fill[ch] -= count;
+    }
+    search_pos = search_pos > count ? search_pos - count : 0;
+}
+
+static void publish(void)
+{
+    size_t bytes = active.record_samples * sizeof(double);
+
+    pthread_mutex_lock(&result_mutex);
+    result.mode     = work.mode;
+    result.samples  = work.samples;
+    result.captures = work.captures;
+    for(int ch = 0; ch < SCOPE_CHANNELS; ch++) {
+        if(active.mode == SCOPE_MODE_PERSIST) {
+            memcpy(result.env_min[ch], work.env_min[ch], bytes);
+            memcpy(result.env_max[ch], work.env_max[ch], bytes);
+        } else {
+            memcpy(result.value[ch], work.value[ch], bytes);
+        }
+    }
+    result_generation++;
+    pthread_mutex_unlock(&result_mutex);
+}
+
+// 每次触发O(记录长度)
+static void capture(uint32_t start)
+{
+    uint32_t n = active.record_samples;
+
+    work.captures++;
+    for(int ch = 0; ch < SCOPE_CHANNELS; ch++) {
+        const double * x = stream[ch] + start;
+        switch(active.mode) {
+            case SCOPE_MODE_AVERAGE: {
+                // 前N次为累积平均, 之后按1/N指数加权, 等效于最近约N次记录的平均
+                uint32_t k = work.captures < active.average ? work.captures : active.average;
+                for(uint32_t i = 0; i < n; i++) work.value[ch][i] += (x[i] - work.value[ch][i]) / k;
+                break;
+            }
+            case SCOPE_MODE_PERSIST:
+                for(uint32_t i = 0; i < n; i++) {
+                    if(work.captures == 1 || x[i] < work.env_min[ch][i]) work.env_min[ch][i] = x[i];
+                    if(work.captures == 1 || x[i] > work.env_max[ch][i]) work.env_max[ch][i] = x[i];
+                }
+                break;
+            default: memcpy(work.value[ch], x, n * sizeof(double)); break;
+        }
+    }
+    publish();
+}
+
+// 在参考通道上找上升沿, 记录两通道都补齐后截取, 一条记录结束前不再触发
+static void process_stream(void)
+{
+    while(1) {
+        bool triggered = false;
+
+        for(; search_pos < stream_fill[0]; search_pos++) {
+            double x = stream[0][search_pos];
+            if(!armed) {
+                armed = x < active.trigger_level - SCOPE_TRIGGER_HYSTERESIS;
+            } else if(x >= active.trigger_level) {
+                triggered = true;
+                break;
+            }
+        }
+
+        // 触发点之前的采样不再需要
+        stream_discard(search_pos);
+        if(!triggered) return;
+
+        uint32_t available = stream_fill[0] < stream_fill[1] ? stream_fill[0] : stream_fill[1];
+        if(search_pos + active.record_samples > available) return;
+
+        capture(search_pos);
+        search_pos += active.record_samples;
+        armed = false;
+    }
+}
+
+static void apply_config(void)
+{
+    pthread_mutex_lock(&config_mutex);
+    active = pending_config;
+    pthread_mutex_unlock(&config_mutex);
+
+    if(active.record_samples == 0 || active.record_samples > SCOPE_MAX_RECORD)
+        active.record_samples = SCOPE_MAX_RECORD;
+    if(active.average == 0) active.average = 1;
+
+    memset(work.value, 0, sizeof(work.value));
+    work.mode     = active.mode;
+    work.samples  = active.record_samples;
+    work.captures = 0;
+    stream_reset();
+}
+
+static void feed_frame(const frame_t * frame)
+{
+    int ch         = frame->channel == SENSOR_CH_REF ? 0 : 1;
+    uint32_t count = frame->count;
+
+    // 缓冲满说明另一通道长时间缺帧, 对齐已不可信, 重新开始
+    if(stream_fill[ch] + count > SCOPE_STREAM_LEN) stream_reset();
+    for(uint32_t i = 0; i < count; i++) stream[ch][stream_fill[ch] + i] = frame->voltage[i];
+    stream_fill[ch] += count;
+
+    process_stream();
+}
+
+static void * scope_thread_func(void * arg)
+{
+    (void)arg;
+
+    while(1) {
+        frame_t * frame = frame_sub_wait(scope_sub, 500);
+
+        if(atomic_exchange(&config_dirty, false)) apply_config();
+        if(frame == NULL) continue;
+
+        // 丢帧后两通道可能错位, 清空缓冲重新对齐
+        uint32_t dropped = frame_sub_dropped(scope_sub);
+        if(dropped != dropped_seen) {
+            dropped_seen = dropped;
+            stream_reset();
+        }
+
+        if(active.mode != SCOPE_MODE_RAW && active.mode != SCOPE_MODE_ROLL) feed_frame(frame);
+        frame_release(frame);
+    }
+
+    return NULL;
+}
+
+int scope_start(void)
+{
+    return frame_bus_start_worker(&scope_sub, FRAME_MASK_REF | FRAME_MASK_ERR, SCOPE_QUEUE_DEPTH, FRAME_DROP_NEWEST,
+                                  scope_thread_func, "scope");
+}
+
+void scope_configure(const scope_config * config)
+{
+    pthread_mutex_lock(&config_mutex);
+    pending_config = *config;
+    pthread_mutex_unlock(&config_mutex);
+    atomic_store(&config_dirty, true);
+}
+
+bool scope_read(scope_trace * trace, uint32_t * generation)
+{
+    bool updated = false;
+
+    pthread_mutex_lock(&result_mutex);
+    if(result_generation != *generation) {
+        size_t bytes    = result.samples * sizeof(double);
+        trace->mode     = result.mode;
+        trace->samples  = result.samples;
+        trace->captures = result.captures;
+        for(int ch = 0; ch < SCOPE_CHANNELS; ch++) {
+            if(result.mode == SCOPE_MODE_PERSIST) {
+                memcpy(trace->env_min[ch], result.env_min[ch], bytes);
+                memcpy(trace->env_max[ch], result.env_max[ch], bytes);
+            } else {
+                memcpy(trace->value[ch], result.value[ch], bytes);
+            }
+        }
+        *generation = result_generation;
+        updated     = true;
+    }
+    pthread_mutex_unlock(&result_mutex);
+
+    return updated;
+}
@@ -0,0 +1,48 @@
+#ifndef SCOPE_H
+#define SCOPE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "frame_bus.h"
+
+// 示波器式显示: 以参考信号上升沿触发对齐, 可叠加多帧相干平均或无限余辉
+// 处理在独立线程中进行, 累加器全部静态分配, 切换模式不分配内存
+#define SCOPE_CHANNELS 2 // 参考/误差
+#define SCOPE_MAX_RECORD FRAME_MAX_SAMPLES
+#define SCOPE_DEFAULT_AVERAGE 16
+#define SCOPE_TRIGGER_HYSTERESIS 0.05 // 触发迟滞(V), 低于电平减迟滞后才重新布防, 抑制噪声误触发
+
+typedef enum {
+    SCOPE_MODE_RAW,     // 不处理, 直接显示实时帧
+    SCOPE_MODE_TRIGGER, // 每次触发显示一条记录
+    SCOPE_MODE_AVERAGE, // 最近N次触发的相干平均, 非相关噪声按√N衰减
+    SCOPE_MODE_PERSIST, // 自切换模式以来所有记录的逐点最小/最大包络
+    SCOPE_MODE_ROLL,    // 滚动显示, 由UI直接从波形历史取数, 本线程不处理
+    SCOPE_MODE_COUNT
+} scope_mode;
+
+typedef struct
+{
+    scope_mode mode;
+    uint16_t record_samples; // 每条记录的采样数, 不超过SCOPE_MAX_RECORD
+    uint16_t average;        // 平均次数N
+    double trigger_level;    // 触发电平(V)
+} scope_config;
+
+typedef struct
+{
+    scope_mode mode;
+    uint16_t samples;
+    uint32_t captures; // 当前模式下累计触发次数
+    double value[SCOPE_CHANNELS][SCOPE_MAX_RECORD];   // 触发/平均模式的结果
+    double env_min[SCOPE_CHANNELS][SCOPE_MAX_RECORD]; // 余辉模式的包络
+    double env_max[SCOPE_CHANNELS][SCOPE_MAX_RECORD];
+} scope_trace;
+
+int scope_start(void);
+// 更新配置, 处理线程在下一帧生效并清空累加器
+void scope_configure(const scope_config * config);
+// 有新结果时拷贝并返回true, generation记录调用方已取到的版本
+bool scope_read(scope_trace * trace, uint32_t * generation);
+
+#endif // SCOPE_H
@@ -0,0 +1,143 @@
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <stdatomic.h>
+#include "frame_bus.h"
+#include "signal_stats.h"
+
+// 统计需要连续数据, 队列满时丢新帧; 只订阅参考/误差, 每个采样块2帧
+// 线程每个采样只做O(1)的窗口更新, 队列只需吸收线程被抢占的时间, 16个采样块足够
+#define STATS_QUEUE_DEPTH (2 * 16)
+#define STATS_MASK (SIGNAL_STATS_WINDOW - 1)
+#define SNAPSHOT_FRESH 0x4u // 中间缓冲区索引上的新数据标志
+
+// 单调队列, 保存窗口内可能成为最大(最小)值的采样位置, 每个采样最多进出一次
+typedef struct
+{
+    uint32_t pos[SIGNAL_STATS_WINDOW];
+    uint32_t head;
+    uint32_t count;
+} mono_deque;
+
+typedef struct
+{
+    double ring[SIGNAL_STATS_WINDOW]; // 最近一个窗口的采样
+    uint32_t pos;                     // 累计采样数, 回绕不影响差值比较
+    uint32_t filled;
+    double sum_sq;
+    mono_deque max_q;
+    mono_deque min_q;
+} channel_window;
+
+static channel_window windows[2]; // 0: 参考, 1: 误差
+static frame_sub_t * stats_sub;
+static uint64_t err_samples;
+
+// 三缓冲交接: 写者填back后与middle交换, 读者取走middle换回front, 双方均不阻塞
+static signal_stats_snapshot snapshots[3];
+static atomic_uint snapshot_middle = 1;
+static uint32_t snapshot_back      = 0; // 只由统计线程访问
+static uint32_t snapshot_front     = 2; // 只由读者访问
+
+static void deque_push(mono_deque * q, const double * ring, uint32_t pos, double x, bool keep_max)
+{
+    // 先移出新采样进入后滑出窗口的队首, 保证队列长度不超过窗口
+    if(q->count > 0 && (uint32_t)(pos - q->pos[q->head]) >= SIGNAL_STATS_WINDOW) {
+        q->head = (q->head + 1) & STATS_MASK;
+        q->count--;
+    }
+
+    while(q->count > 0) {
+        double back = ring[q->pos[(q->head + q->count - 1) & STATS_MASK] & STATS_MASK];
+        if(keep_max ? back > x : back < x) break;
+        q->count--;
+    }
+    q->pos[(q->head + q->count) & STATS_MASK] = pos;
+    q->count++;
+}
+
+static void window_push(channel_window * w, double x)
+{
+    uint32_t idx = w->pos & STATS_MASK;
+
+    if(w->filled == SIGNAL_STATS_WINDOW) {
+        w->sum_sq -= w->ring[idx] * w->ring[idx];
+    } else {
+        w->filled++;
+    }
+    w->ring[idx] = x;
+    w->sum_sq += x * x;
+
+    deque_push(&w->max_q, w->ring, w->pos, x, true);
+    deque_push(&w->min_q, w->ring, w->pos, x, false);
+    w->pos++;
+
+    // 每滑过一个窗口重算一次平方和, 消除增减累积的舍入误差, 均摊仍为O(1)
+    if((w->pos & STATS_MASK) == 0) {
+        w->sum_sq = 0.0;
+        for(uint32_t i = 0; i < w->filled; i++) w->sum_sq += w->ring[i] * w->ring[i];
+    }
+}
+
+static void window_stats(const channel_window * w, signal_channel_stats * stats)
+{
+    memset(stats, 0, sizeof(*stats));
+    if(w->filled == 0) return;
+
+    stats->rms   = sqrt(w->sum_sq / w->filled);
+    stats->max   = w->ring[w->max_q.pos[w->max_q.head] & STATS_MASK];
+    stats->min   = w->ring[w->min_q.pos[w->min_q.head] & STATS_MASK];
+    stats->peak  = fmax(fabs(stats->max), fabs(stats->min));
+    stats->crest = stats->rms > 0.0 ? stats->peak / stats->rms : 0.0;
+}
+
+static void publish_snapshot(void)
+{
+    signal_stats_snapshot * snapshot = &snapshots[snapshot_back];
+
+    window_stats(&windows[0], &snapshot->ref);
+    window_stats(&windows[1], &snapshot->err);
+    snapshot->attenuation_db = snapshot->ref.rms > 0.0 && snapshot->err.rms > 0.0
+                                   ? 20.0 * log10(snapshot->ref.rms / snapshot->err.rms)
+                                   : 0.0;
+    snapshot->samples        = err_samples;
+
+    snapshot_back = atomic_exchange(&snapshot_middle, snapshot_back | SNAPSHOT_FRESH) & ~SNAPSHOT_FRESH;
+}
+
+static void * stats_thread_func(void * arg)
+{
+    (void)arg;
+
+    while(1) {
+        frame_t * frame = frame_sub_wait(stats_sub, 500);
+        if(frame == NULL) continue;
+
+        channel_window * w = &windows[frame->channel == SENSOR_CH_REF ? 0 : 1];
+        for(int i = 0; i < frame->count; i++) window_push(w, frame->voltage[i]);
+        if(frame->channel == SENSOR_CH_ERR) err_samples += frame->count;
+        frame_release(frame);
+
+        publish_snapshot();
+    }
+
+    return NULL;
+}
+
+int signal_stats_start(void)
+{
+    return frame_bus_start_worker(&stats_sub, FRAME_MASK_REF | FRAME_MASK_ERR, STATS_QUEUE_DEPTH, FRAME_DROP_NEWEST,
+                                  stats_thread_func, "stats");
+}
+
+bool signal_stats_read(signal_stats_snapshot * snapshot)
+{
+    if((atomic_load(&snapshot_middle) & SNAPSHOT_FRESH) == 0) return false;
+
+    snapshot_front = atomic_exchange(&snapshot_middle, snapshot_front) & ~SNAPSHOT_FRESH;
+    *snapshot      = snapshots[snapshot_front];
+
+    return true;
+}
@@ -0,0 +1,31 @@
+#ifndef SIGNAL_STATS_H
+#define SIGNAL_STATS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// 参考/误差信号滑动窗口统计, 每个采样O(1)更新
+#define SIGNAL_STATS_WINDOW 4096 // 窗口长度(采样点), 2的幂
+
+typedef struct
+{
+    double rms;
+    double peak;  // 窗口内|x|最大值
+    double crest; // 峰值因数 peak / rms
+    double max;
+    double min;
+} signal_channel_stats;
+
+typedef struct
+{
+    signal_channel_stats ref;
+    signal_channel_stats err;
+    double attenuation_db; // 20·log10(ref_rms / err_rms), 误差越小越大
+    uint64_t samples;      // 已处理的误差通道采样数
+} signal_stats_snapshot;
+
+int signal_stats_start(void);
+// 无锁读取最新快照, 有新数据时返回true; 只允许单个读者(UI线程)
+bool signal_stats_read(signal_stats_snapshot * snapshot);
+
+#endif // SIGNAL_STATS_H
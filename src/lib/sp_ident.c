@@ -0,0 +1,208 @@
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include "linux_msg.h"
+#include "sp_ident.h"
+
+#define SP_CHUNK_TIMEOUT_US 500000 // 拼接中超过此时间没有新分块视为末尾丢失, 请求重发
+#define SP_MAX_RETRIES 3           // 没有任何进展时连续重发请求的上限, 收到新分块后重新计数
+
+// 拼接状态由接收线程更新, 重发线程只读取进度
+static pthread_mutex_t assembly_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t assembly_cond   = PTHREAD_COND_INITIALIZER;
+static struct
+{
+    bool active;
+    uint32_t ident_id;
+    uint32_t sample_rate;
+    uint16_t total;
+    uint16_t received; // 已按顺序收到的系数数
+    uint64_t last_us;  // 最近一次收到分块的时刻
+    uint32_t retries;        // 自上次收到可拼接分块以来的重发请求数
+    bool request_pending;    // 发现缺块, 等待重发线程发出请求
+    bool resend_outstanding; // 已请求重发, 缺口处的分块到达前不再因缺块重复请求
+    float coeff[SP_COEFF_MAX_TAPS];
+} assembly;
+
+// 结果缓存, 环形覆盖最旧结果
+static pthread_mutex_t cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+static sp_ident_result cache[SP_IDENT_CACHE_SIZE];
+static uint32_t cache_count;
+static uint32_t cache_head; // 下一次写入位置
+static uint32_t cache_generation;
+static sp_ident_notify result_notify;
+
+static void cache_store(void)
+{
+    sp_ident_result * slot = NULL;
+
+    pthread_mutex_lock(&cache_mutex);
+    // 同一次辨识重复收到时覆盖原条目, 不占用新位置
+    for(uint32_t i = 0; i < cache_count; i++) {
+        if(cache[i].ident_id == assembly.ident_id) slot = &cache[i];
+    }
+    if(slot == NULL) {
+        slot       = &cache[cache_head];
+        cache_head = (cache_head + 1) % SP_IDENT_CACHE_SIZE;
+        if(cache_count < SP_IDENT_CACHE_SIZE) cache_count++;
+    }
+    slot->ident_id    = assembly.ident_id;
+    slot->sample_rate = assembly.sample_rate;
+    slot->taps        = assembly.total;
+    slot->received_us = rpmsg_now_us();
+    memcpy(slot->coeff, assembly.coeff, assembly.total * sizeof(float));
+    cache_generation++;
+    pthread_mutex_unlock(&cache_mutex);
+}
+
+// 在接收线程中执行, 只做拷贝, 重发请求交给重发线程以免阻塞接收
+static void handle_coeff_chunk(const rpmsg_msg * msg, void * user_data)
+{
+    CoeffChunkHeader hdr;
+    uint16_t body = msg->length - sizeof(hdr);
+    uint16_t count;
+    bool stored = false;
+
+    (void)user_data;
+
+    memcpy(&hdr, msg->payload, sizeof(hdr));
+    count = body / sizeof(float);
+    if(body % sizeof(float) != 0 || hdr.total == 0 || hdr.total > SP_COEFF_MAX_TAPS ||
+       hdr.offset + count > hdr.total) {
+        printf("WARNING: bad coefficient chunk, id %u offset %u total %u length %u\n", hdr.ident_id, hdr.offset,
+               hdr.total, msg->length);
+        return;
+    }
+
+    pthread_mutex_lock(&assembly_mutex);
+    if(!assembly.active || assembly.ident_id != hdr.ident_id || hdr.offset == 0) {
+        assembly.active             = true;
+        assembly.ident_id           = hdr.ident_id;
+        assembly.sample_rate        = hdr.sample_rate;
+        assembly.total              = hdr.total;
+        assembly.received           = 0;
+        assembly.retries            = 0;
+        assembly.request_pending    = false;
+        assembly.resend_outstanding = false;
+    }
+    assembly.last_us = rpmsg_now_us();
+
+    if(hdr.offset == assembly.received) {
+        memcpy(assembly.coeff + hdr.offset, msg->payload + sizeof(hdr), count * sizeof(float));
+        assembly.received += count;
+        // 有进展即重新计数; 通道按序送达, 缺口之后能拼接上的分块只能是重发的分块, 重发已生效
+        assembly.retries            = 0;
+        assembly.resend_outstanding = false;
+        if(assembly.received == assembly.total) {
+            assembly.active = false;
+            cache_store();
+            stored = true;
+            printf("Secondary path identification %u received, %u taps\n", assembly.ident_id, assembly.total);
+        }
+    } else if(hdr.offset > assembly.received && !assembly.request_pending && !assembly.resend_outstanding) {
+        // 中间缺块, 之后的分块都无法拼接, 请求从缺口处重发; 请求发出前已在途的后续分块不再触发请求
+        assembly.request_pending = true;
+        pthread_cond_signal(&assembly_cond);
+    }
+    pthread_mutex_unlock(&assembly_mutex);
+
+    if(stored && result_notify != NULL) result_notify();
+}
+
+static void * resend_thread_func(void * arg)
+{
+    (void)arg;
+
+    while(1) {
+        struct timespec deadline;
+        bool send = false;
+        uint32_t ident_id;
+        uint16_t offset;
+
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_nsec += SP_CHUNK_TIMEOUT_US * 1000L;
+        deadline.tv_sec += deadline.tv_nsec / 1000000000L;
+        deadline.tv_nsec %= 1000000000L;
+
+        pthread_mutex_lock(&assembly_mutex);
+        if(!assembly.request_pending) pthread_cond_timedwait(&assembly_cond, &assembly_mutex, &deadline);
+        bool stalled = assembly.active && rpmsg_now_us() - assembly.last_us > SP_CHUNK_TIMEOUT_US;
+        if((assembly.request_pending || stalled) && assembly.active && assembly.retries < SP_MAX_RETRIES) {
+            assembly.retries++;
+            assembly.resend_outstanding = true;
+            assembly.last_us            = rpmsg_now_us();
+            ident_id                    = assembly.ident_id;
+            offset                      = assembly.received;
+            send                        = true;
+        } else if(stalled) {
+            printf("WARNING: identification %u incomplete, %u/%u taps\n", assembly.ident_id, assembly.received,
+                   assembly.total);
+            assembly.active = false;
+        }
+        assembly.request_pending = false;
+        pthread_mutex_unlock(&assembly_mutex);
+
+        if(send) rpmsg_request_coeff(ident_id, offset);
+    }
+
+    return NULL;
+}
+
+int sp_ident_start(void)
+{
+    pthread_t thread;
+
+    if(rpmsg_register_handler(MSG_SP_COEFF, handle_coeff_chunk, NULL) != 0) return -1;
+    if(pthread_create(&thread, NULL, resend_thread_func, NULL) != 0) {
+        perror("Failed to create coefficient resend thread");
+        return -1;
+    }
+    pthread_detach(thread);
+
+    return 0;
+}
+
+void sp_ident_set_notify(sp_ident_notify notify)
+{
+    result_notify = notify;
+}
+
+int sp_ident_request(uint32_t ident_id)
+{
+    return rpmsg_request_coeff(ident_id, 0);
+}
+
+uint32_t sp_ident_count(uint32_t * generation)
+{
+    uint32_t count;
+
+    pthread_mutex_lock(&cache_mutex);
+    count = cache_count;
+    if(generation) *generation = cache_generation;
+    pthread_mutex_unlock(&cache_mutex);
+
+    return count;
+}
+
+bool sp_ident_get(uint32_t index, sp_ident_result * result)
+{
+    bool found = false;
+
+    pthread_mutex_lock(&cache_mutex);
+    if(index < cache_count) {
+        const sp_ident_result * slot =
+            &cache[(cache_head + SP_IDENT_CACHE_SIZE - 1 - index) % SP_IDENT_CACHE_SIZE];
+        result->ident_id    = slot->ident_id;
+        result->sample_rate = slot->sample_rate;
+        result->taps        = slot->taps;
+        result->received_us = slot->received_us;
+        memcpy(result->coeff, slot->coeff, slot->taps * sizeof(float));
+        found = true;
+    }
+    pthread_mutex_unlock(&cache_mutex);
+
+    return found;
+}
@@ -0,0 +1,34 @@
+#ifndef SP_IDENT_H
+#define SP_IDENT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "rpmsg_protocol.h"
+
+// 次级通道辨识结果: 接收线程拼接MSG_SP_COEFF分块, 完整结果存入缓存供界面对比
+#define SP_IDENT_CACHE_SIZE 8 // 保留最近几次辨识结果
+
+typedef struct
+{
+    uint32_t ident_id;
+    uint32_t sample_rate;
+    uint16_t taps;
+    uint64_t received_us; // 接收完成时刻(CLOCK_MONOTONIC, 微秒)
+    float coeff[SP_COEFF_MAX_TAPS];
+} sp_ident_result;
+
+// 新结果存入缓存后在接收线程中调用, 不能直接访问LVGL
+typedef void (*sp_ident_notify)(void);
+
+// 注册消息处理函数并启动重发请求线程, 须在start_rpmsg之前调用
+int sp_ident_start(void);
+// 设置新结果通知, 须在sp_ident_start之前调用
+void sp_ident_set_notify(sp_ident_notify notify);
+// 请求实时端发送辨识结果, ident_id为0表示最近一次
+int sp_ident_request(uint32_t ident_id);
+// 缓存中的结果数, 以及每存入一次结果加1的版本号
+uint32_t sp_ident_count(uint32_t * generation);
+// index为0表示最新结果, 越大越旧
+bool sp_ident_get(uint32_t index, sp_ident_result * result);
+
+#endif // SP_IDENT_H
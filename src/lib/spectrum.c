@@ -0,0 +1,115 @@
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+#include "frame_bus.h"
+#include "rfft.h"
+#include "spectrum.h"
+
+#define SPECTRUM_HOP (SPECTRUM_FFT_SIZE / 2) // 50%重叠, Hann窗在此重叠率下满足COLA
+#define SPECTRUM_QUEUE_DEPTH 32              // 分析线程落后时丢最旧帧, 不阻塞接收线程
+#define SPECTRUM_AVG_ALPHA 0.3f              // 功率谱指数平均系数, 越大响应越快
+
+// 以下缓冲区只由分析线程访问, 启动前一次性准备好
+static rfft_plan plan;
+static frame_sub_t * spectrum_sub;
+static float window[SPECTRUM_FFT_SIZE];
+static float history[SPECTRUM_FFT_SIZE]; // 最近一个窗长的采样
+static uint32_t history_fill;
+static float windowed[SPECTRUM_FFT_SIZE];
+static float bin_re[SPECTRUM_BINS];
+static float bin_im[SPECTRUM_BINS];
+static float power_avg[SPECTRUM_BINS];
+static float power_scale; // 单边幅度谱归一化, 满幅正弦在其频点为0 dBV
+
+// 与UI线程交接的结果, 锁内只做一次拷贝
+static pthread_mutex_t result_mutex = PTHREAD_MUTEX_INITIALIZER;
+static float result_db[SPECTRUM_BINS];
+static uint32_t result_generation;
+
+static void analyze_window(void)
+{
+    static float db[SPECTRUM_BINS];
+
+    for(int i = 0; i < SPECTRUM_FFT_SIZE; i++) windowed[i] = history[i] * window[i];
+    rfft_forward(&plan, windowed, bin_re, bin_im);
+
+    for(int k = 0; k < SPECTRUM_BINS; k++) {
+        float power  = (bin_re[k] * bin_re[k] + bin_im[k] * bin_im[k]) * power_scale;
+        power_avg[k] = power_avg[k] + SPECTRUM_AVG_ALPHA * (power - power_avg[k]);
+        db[k]        = power_avg[k] > 0.0f ? 10.0f * log10f(power_avg[k]) : SPECTRUM_DB_FLOOR;
+        if(db[k] < SPECTRUM_DB_FLOOR) db[k] = SPECTRUM_DB_FLOOR;
+    }
+
+    pthread_mutex_lock(&result_mutex);
+    memcpy(result_db, db, sizeof(result_db));
+    result_generation++;
+    pthread_mutex_unlock(&result_mutex);
+}
+
+// 逐帧累积采样, 每凑满一个跳步分析一次, 帧长与窗长无需对齐
+static void feed_frame(const frame_t * frame)
+{
+    for(int i = 0; i < frame->count; i++) {
+        history[history_fill++] = (float)frame->voltage[i];
+        if(history_fill == SPECTRUM_FFT_SIZE) {
+            analyze_window();
+            memmove(history, history + SPECTRUM_HOP, (SPECTRUM_FFT_SIZE - SPECTRUM_HOP) * sizeof(float));
+            history_fill = SPECTRUM_FFT_SIZE - SPECTRUM_HOP;
+        }
+    }
+}
+
+static void * spectrum_thread_func(void * arg)
+{
+    (void)arg;
+
+    while(1) {
+        frame_t * frame = frame_sub_wait(spectrum_sub, 500);
+        if(frame == NULL) continue;
+        feed_frame(frame);
+        frame_release(frame);
+    }
+
+    return NULL;
+}
+
+int spectrum_start(uint16_t channel)
+{
+    double window_sum = 0.0;
+
+    if(rfft_init(&plan, SPECTRUM_FFT_SIZE) != 0) return -1;
+
+    for(int i = 0; i < SPECTRUM_FFT_SIZE; i++) {
+        window[i] = 0.5f - 0.5f * (float)cos(2.0 * 3.14159265358979323846 * i / SPECTRUM_FFT_SIZE);
+        window_sum += window[i];
+    }
+    // |X|·2/Σw 为正弦幅值, 取有效值后平方: (2/Σw)² / 2
+    power_scale = (float)(2.0 / (window_sum * window_sum));
+    for(int k = 0; k < SPECTRUM_BINS; k++) result_db[k] = SPECTRUM_DB_FLOOR;
+
+    if(frame_bus_start_worker(&spectrum_sub, FRAME_CHANNEL_MASK(channel), SPECTRUM_QUEUE_DEPTH, FRAME_DROP_OLDEST,
+                              spectrum_thread_func, "spectrum") != 0) {
+        rfft_free(&plan);
+        return -1;
+    }
+
+    return 0;
+}
+
+bool spectrum_read(float * db, uint32_t * generation)
+{
+    bool updated = false;
+
+    pthread_mutex_lock(&result_mutex);
+    if(result_generation != *generation) {
+        memcpy(db, result_db, sizeof(result_db));
+        *generation = result_generation;
+        updated     = true;
+    }
+    pthread_mutex_unlock(&result_mutex);
+
+    return updated;
+}
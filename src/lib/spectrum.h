@@ -0,0 +1,16 @@
+#ifndef SPECTRUM_H
+#define SPECTRUM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// 误差信号频谱分析: 独立线程订阅帧总线, Hann窗50%重叠, 每半窗输出一次幅度谱
+#define SPECTRUM_FFT_SIZE 1024
+#define SPECTRUM_BINS (SPECTRUM_FFT_SIZE / 2 + 1)
+#define SPECTRUM_DB_FLOOR -120.0f // 输出下限, 避免log10(0)
+
+int spectrum_start(uint16_t channel);
+// 有新频谱时拷贝到db(SPECTRUM_BINS个, 单位dBV)并返回true, generation记录调用方已取到的版本
+bool spectrum_read(float * db, uint32_t * generation);
+
+#endif // SPECTRUM_H
@@ -0,0 +1,85 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include "ui_post.h"
+
+// 每个槽位带序号: 等于写入位置时可写, 等于写入位置+1时可读, 读完后推进一圈
+// 生产者之间只竞争enqueue_pos一个CAS, 消费者不需要原子读改写
+typedef struct
+{
+    atomic_uint sequence;
+    ui_post_cb cb;
+    void * user_data;
+} ui_post_slot;
+
+typedef char ui_post_capacity_is_pow2[(UI_POST_CAPACITY & (UI_POST_CAPACITY - 1)) == 0 ? 1 : -1];
+
+static ui_post_slot slots[UI_POST_CAPACITY];
+static atomic_uint enqueue_pos;
+static atomic_uint dropped;
+static uint32_t dequeue_pos; // 只由LVGL线程访问
+
+void ui_post_init(void)
+{
+    for(uint32_t i = 0; i < UI_POST_CAPACITY; i++) atomic_init(&slots[i].sequence, i);
+    atomic_init(&enqueue_pos, 0);
+    atomic_init(&dropped, 0);
+    dequeue_pos = 0;
+}
+
+bool ui_post(ui_post_cb cb, void * user_data)
+{
+    unsigned pos = atomic_load_explicit(&enqueue_pos, memory_order_relaxed);
+    ui_post_slot * slot;
+
+    while(1) {
+        slot         = &slots[pos & (UI_POST_CAPACITY - 1)];
+        unsigned seq = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        int diff     = (int)(seq - pos);
+
+        if(diff == 0) {
+            // 抢占该位置, 失败时pos被更新为最新的写入位置
+            if(atomic_compare_exchange_weak_explicit(&enqueue_pos, &pos, pos + 1, memory_order_relaxed,
+                                                     memory_order_relaxed))
+                break;
+        } else if(diff < 0) {
+            // 槽位还未被消费者取走, 队列满
+            atomic_fetch_add_explicit(&dropped, 1, memory_order_relaxed);
+            return false;
+        } else {
+            pos = atomic_load_explicit(&enqueue_pos, memory_order_relaxed);
+        }
+    }
+
+    slot->cb        = cb;
+    slot->user_data = user_data;
+    atomic_store_explicit(&slot->sequence, pos + 1, memory_order_release);
+
+    return true;
+}
+
+uint32_t ui_post_drain(void)
+{
+    uint32_t done = 0;
+
+    // 最多执行一圈, 回调中再投递的请求留到下一轮, 避免主循环被占住
+    while(done < UI_POST_CAPACITY) {
+        ui_post_slot * slot = &slots[dequeue_pos & (UI_POST_CAPACITY - 1)];
+        if(atomic_load_explicit(&slot->sequence, memory_order_acquire) != dequeue_pos + 1) break;
+
+        ui_post_cb cb    = slot->cb;
+        void * user_data = slot->user_data;
+        atomic_store_explicit(&slot->sequence, dequeue_pos + UI_POST_CAPACITY, memory_order_release);
+        dequeue_pos++;
+
+        cb(user_data);
+        done++;
+    }
+
+    return done;
+}
+
+uint32_t ui_post_dropped(void)
+{
+    return atomic_load_explicit(&dropped, memory_order_relaxed);
+}
@@ -0,0 +1,22 @@
+#ifndef UI_POST_H
+#define UI_POST_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// 把后台线程的界面更新请求转交给LVGL线程执行: 有界无锁多生产者单消费者队列
+// 任意线程可投递, 只有主循环取出执行, 回调中可以直接调用LVGL; 后台线程不得直接访问LVGL对象
+#define UI_POST_CAPACITY 64 // 队列容量, 2的幂
+
+typedef void (*ui_post_cb)(void * user_data);
+
+// 须在任何线程投递之前调用
+void ui_post_init(void);
+// 任意线程调用, 队列满时丢弃并返回false; user_data须在回调执行前保持有效
+bool ui_post(ui_post_cb cb, void * user_data);
+// 只在LVGL线程调用, 依次执行投递时已入队的请求, 返回执行数
+uint32_t ui_post_drain(void);
+// 因队列满被丢弃的请求数
+uint32_t ui_post_dropped(void);
+
+#endif // UI_POST_H
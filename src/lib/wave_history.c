@@ -0,0 +1,174 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <math.h>
+#include <pthread.h>
+#include "frame_bus.h"
+#include "wave_history.h"
+
+// 历史需要连续数据, 队列满时丢新帧; 只订阅参考/误差, 每个采样块2帧
+// UI线程渲染历史视图时持锁逐列查询各级min/max, 期间到达的采样块在队列中等待, 按16个采样块留余量
+#define HISTORY_QUEUE_DEPTH (2 * 16)
+#define HISTORY_MASK (WAVE_HISTORY_DEPTH - 1)
+#define LEVEL_SHIFT(k) (2u * (k))
+
+typedef struct
+{
+    float * samples;                        // 第0级: 原始采样
+    float * level_min[WAVE_HISTORY_LEVELS]; // 第1级起, 每级桶数为上一级的1/4
+    float * level_max[WAVE_HISTORY_LEVELS];
+    uint64_t total; // 累计写入采样数
+} channel_history;
+
+static channel_history histories[WAVE_HISTORY_CHANNELS];
+static pthread_mutex_t history_mutex = PTHREAD_MUTEX_INITIALIZER;
+static frame_sub_t * history_sub;
+
+static void history_push(channel_history * h, float x)
+{
+    uint64_t n = h->total;
+
+    h->samples[n & HISTORY_MASK] = x;
+
+    // 逐级更新所在桶; 桶已覆盖x时更高级的桶必然也覆盖, 提前结束
+    for(uint32_t k = 1; k < WAVE_HISTORY_LEVELS; k++) {
+        uint32_t slot = (uint32_t)((n >> LEVEL_SHIFT(k)) & (HISTORY_MASK >> LEVEL_SHIFT(k)));
+        if((n & ((1ull << LEVEL_SHIFT(k)) - 1)) == 0) {
+            h->level_min[k][slot] = x;
+            h->level_max[k][slot] = x;
+        } else if(x < h->level_min[k][slot]) {
+            h->level_min[k][slot] = x;
+        } else if(x > h->level_max[k][slot]) {
+            h->level_max[k][slot] = x;
+        } else {
+            break;
+        }
+    }
+
+    h->total = n + 1;
+}
+
+// 合并[a, b)内的桶, 第k级每桶4^k个采样, 边界桶按整桶计入(误差小于一列)
+static void history_column(const channel_history * h, uint64_t a, uint64_t b, float * out_min, float * out_max)
+{
+    uint64_t oldest = h->total > WAVE_HISTORY_DEPTH ? h->total - WAVE_HISTORY_DEPTH : 0;
+    uint64_t span;
+    uint32_t k = 0;
+    float lo   = INFINITY;
+    float hi   = -INFINITY;
+
+    if(b > h->total) b = h->total;
+    if(a < oldest) a = oldest;
+    span = b > a ? b - a : 0;
+    while(k + 1 < WAVE_HISTORY_LEVELS && (1ull << LEVEL_SHIFT(k + 1)) <= span) k++;
+
+    // 最旧的桶可能已被最新桶复用, 从下一个整桶开始
+    if(k > 0 && oldest > 0) {
+        uint64_t first = ((oldest >> LEVEL_SHIFT(k)) + 1) << LEVEL_SHIFT(k);
+        if(a < first) a = first;
+    }
+    if(a >= b) {
+        *out_min = NAN;
+        *out_max = NAN;
+        return;
+    }
+
+    if(k == 0) {
+        for(uint64_t n = a; n < b; n++) {
+            float x = h->samples[n & HISTORY_MASK];
+            lo      = fminf(lo, x);
+            hi      = fmaxf(hi, x);
+        }
+    } else {
+        uint32_t mask = HISTORY_MASK >> LEVEL_SHIFT(k);
+        for(uint64_t bucket = a >> LEVEL_SHIFT(k); bucket <= (b - 1) >> LEVEL_SHIFT(k); bucket++) {
+            lo = fminf(lo, h->level_min[k][bucket & mask]);
+            hi = fmaxf(hi, h->level_max[k][bucket & mask]);
+        }
+    }
+
+    *out_min = lo;
+    *out_max = hi;
+}
+
+static void * history_thread_func(void * arg)
+{
+    (void)arg;
+
+    while(1) {
+        frame_t * frame = frame_sub_wait(history_sub, 500);
+        if(frame == NULL) continue;
+
+        channel_history * h = &histories[frame->channel];
+        pthread_mutex_lock(&history_mutex);
+        for(int i = 0; i < frame->count; i++) history_push(h, (float)frame->voltage[i]);
+        pthread_mutex_unlock(&history_mutex);
+        frame_release(frame);
+    }
+
+    return NULL;
+}
+
+int wave_history_start(void)
+{
+    for(int ch = 0; ch < WAVE_HISTORY_CHANNELS; ch++) {
+        channel_history * h = &histories[ch];
+        h->samples          = calloc(WAVE_HISTORY_DEPTH, sizeof(float));
+        bool ok             = h->samples != NULL;
+        for(uint32_t k = 1; k < WAVE_HISTORY_LEVELS; k++) {
+            h->level_min[k] = calloc(WAVE_HISTORY_DEPTH >> LEVEL_SHIFT(k), sizeof(float));
+            h->level_max[k] = calloc(WAVE_HISTORY_DEPTH >> LEVEL_SHIFT(k), sizeof(float));
+            ok              = ok && h->level_min[k] != NULL && h->level_max[k] != NULL;
+        }
+        if(!ok) {
+            perror("Waveform history allocation failed");
+            goto fail;
+        }
+    }
+
+    if(frame_bus_start_worker(&history_sub, FRAME_MASK_REF | FRAME_MASK_ERR, HISTORY_QUEUE_DEPTH, FRAME_DROP_NEWEST,
+                              history_thread_func, "history") != 0)
+        goto fail;
+
+    return 0;
+
+fail:
+    for(int ch = 0; ch < WAVE_HISTORY_CHANNELS; ch++) {
+        free(histories[ch].samples);
+        for(uint32_t k = 1; k < WAVE_HISTORY_LEVELS; k++) {
+            free(histories[ch].level_min[k]);
+            free(histories[ch].level_max[k]);
+        }
+    }
+    return -1;
+}
+
+uint64_t wave_history_latest(uint16_t channel)
+{
+    uint64_t total;
+
+    if(channel >= WAVE_HISTORY_CHANNELS) return 0;
+    pthread_mutex_lock(&history_mutex);
+    total = histories[channel].total;
+    pthread_mutex_unlock(&history_mutex);
+
+    return total;
+}
+
+void wave_history_render(uint16_t channel, uint64_t end, uint64_t span, uint32_t columns, float * col_min,
+                         float * col_max)
+{
+    uint64_t start = end > span ? end - span : 0;
+
+    if(channel >= WAVE_HISTORY_CHANNELS) return;
+
+    pthread_mutex_lock(&history_mutex);
+    for(uint32_t c = 0; c < columns; c++) {
+        uint64_t a = start + span * c / columns;
+        uint64_t b = start + span * (c + 1) / columns;
+        if(b == a) b = a + 1; // 采样比列少时相邻列重复同一采样
+        history_column(&histories[channel], a, b, &col_min[c], &col_max[c]);
+    }
+    pthread_mutex_unlock(&history_mutex);
+}
@@ -0,0 +1,19 @@
+#ifndef WAVE_HISTORY_H
+#define WAVE_HISTORY_H
+
+#include <stdint.h>
+
+// 长时间波形历史: 原始采样环形缓冲 + 逐级4倍抽取的最小/最大值金字塔
+// 任意时间跨度按像素列查询, 每列只访问固定几个桶, 代价与历史长度无关
+#define WAVE_HISTORY_CHANNELS 2       // 记录参考/误差两个通道
+#define WAVE_HISTORY_DEPTH (1u << 20) // 每通道保留的采样数, 8 kHz下约2分钟
+#define WAVE_HISTORY_LEVELS 10        // 金字塔级数, 第k级每桶覆盖4^k个采样
+
+int wave_history_start(void);
+// 通道累计写入的采样数, 即下一个采样的绝对序号
+uint64_t wave_history_latest(uint16_t channel);
+// 将[end - span, end)按columns列输出每列最小/最大值, 无数据的列输出NAN
+void wave_history_render(uint16_t channel, uint64_t end, uint64_t span, uint32_t columns, float * col_min,
+                         float * col_max);
+
+#endif // WAVE_HISTORY_H
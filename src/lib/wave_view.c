@@ -0,0 +1,655 @@
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "wave_view.h"
+
+#define SPAN_EMPTY INT16_MAX // 区间上端为此值表示该列无数据
+#define WAVE_VIEW_MAX_SCRATCH 4 // 一次重建底图中竖排文字的临时缓冲数
+
+typedef struct
+{
+    bool used;
+    uint16_t color;   // RGB565
+    int16_t * top;    // 每列区间上端行号
+    int16_t * bottom; // 每列区间下端行号(未加粗)
+} wave_trace;
+
+typedef struct
+{
+    int32_t full_width; // 控件尺寸, 底图和帧缓冲覆盖整个控件(含坐标轴边距)
+    int32_t full_height;
+    int32_t plot_x; // 绘图区(内容区)在控件内的偏移和尺寸, 曲线只画在绘图区内
+    int32_t plot_y;
+    int32_t width;
+    int32_t height;
+    double range_min;
+    double range_max;
+    uint8_t hdiv;
+    uint8_t vdiv;
+    bool background_valid;   // 底图与当前尺寸/样式/装饰一致
+    bool background_pending; // 已排队异步重建
+    bool frame_valid;        // 帧缓冲与曲线区间一致, 除stale_x1..stale_x2列外
+    bool frame_stale;        // 帧缓冲有待重新合成的列
+    int32_t stale_x1;        // 待合成的列范围(绘图区坐标)
+    int32_t stale_x2;
+    lv_draw_buf_t * background;
+    lv_draw_buf_t * frame;
+    lv_obj_t * canvas; // 隐藏的画布, 只用于把装饰绘制到底图
+    wave_view_decor_cb_t decor_cb;
+    void * decor_user_data;
+    lv_draw_buf_t * scratch[WAVE_VIEW_MAX_SCRATCH];
+    int scratch_count;
+    int16_t * spans; // 所有曲线的区间数组, 尺寸变化时整体重新分配
+    wave_trace trace[WAVE_VIEW_MAX_TRACES];
+} wave_view_t;
+
+// 一次更新中变化列的包围盒(绘图区坐标)
+typedef struct
+{
+    bool any;
+    int32_t x1, x2, y1, y2;
+} wave_dirty;
+
+static void background_rebuild_cb(void * data);
+
+static void free_buffers(wave_view_t * view)
+{
+    lv_free(view->spans);
+    if(view->background != NULL) {
+        lv_image_cache_drop(view->background);
+        lv_draw_buf_destroy(view->background);
+    }
+    if(view->frame != NULL) {
+        lv_image_cache_drop(view->frame);
+        lv_draw_buf_destroy(view->frame);
+    }
+    view->spans            = NULL;
+    view->background       = NULL;
+    view->frame            = NULL;
+    view->full_width       = 0;
+    view->full_height      = 0;
+    view->background_valid = false;
+}
+
+// 底图过期后在下一轮定时器处理中重建, 绘制回调里不能嵌套渲染装饰
+static void background_invalidate(lv_obj_t * obj, wave_view_t * view)
+{
+    view->background_valid = false;
+    view->frame_valid      = false;
+    if(view->background_pending) return;
+    view->background_pending = true;
+    lv_async_call(background_rebuild_cb, obj);
+}
+
+// 按控件和内容区尺寸(重新)分配缓冲区, 尺寸未确定或分配失败返回false
+static bool ensure_size(lv_obj_t * obj, wave_view_t * view)
+{
+    lv_area_t coords;
+    lv_area_t content;
+
+    lv_obj_get_coords(obj, &coords);
+    lv_obj_get_content_coords(obj, &content);
+    int32_t full_w = lv_area_get_width(&coords);
+    int32_t full_h = lv_area_get_height(&coords);
+    int32_t w      = lv_area_get_width(&content);
+    int32_t h      = lv_area_get_height(&content);
+
+    if(view->frame != NULL && full_w == view->full_width && full_h == view->full_height && w == view->width &&
+       h == view->height && content.x1 - coords.x1 == view->plot_x && content.y1 - coords.y1 == view->plot_y)
+        return true;
+
+    free_buffers(view);
+    if(w <= 0 || h <= 0 || h >= SPAN_EMPTY) return false;
+
+    view->spans      = lv_malloc((size_t)w * WAVE_VIEW_MAX_TRACES * 2 * sizeof(int16_t));
+    view->background = lv_draw_buf_create(full_w, full_h, LV_COLOR_FORMAT_RGB565, LV_STRIDE_AUTO);
+    view->frame      = lv_draw_buf_create(full_w, full_h, LV_COLOR_FORMAT_RGB565, LV_STRIDE_AUTO);
+    if(view->spans == NULL || view->background == NULL || view->frame == NULL) {
+        LV_LOG_WARN("wave_view: out of memory for %dx%d", (int)full_w, (int)full_h);
+        free_buffers(view);
+        return false;
+    }
+
+    view->full_width  = full_w;
+    view->full_height = full_h;
+    view->plot_x      = content.x1 - coords.x1;
+    view->plot_y      = content.y1 - coords.y1;
+    view->width       = w;
+    view->height      = h;
+    for(int i = 0; i < WAVE_VIEW_MAX_TRACES; i++) {
+        view->trace[i].top    = view->spans + (size_t)w * 2 * i;
+        view->trace[i].bottom = view->trace[i].top + w;
+        for(int32_t c = 0; c < w; c++) view->trace[i].top[c] = SPAN_EMPTY;
+    }
+    background_invalidate(obj, view);
+
+    return true;
+}
+
+static wave_trace * trace_get(lv_obj_t * obj, int trace, wave_view_t ** view)
+{
+    *view = lv_obj_get_user_data(obj);
+    if(*view == NULL || trace < 0 || trace >= WAVE_VIEW_MAX_TRACES || !(*view)->trace[trace].used) return NULL;
+    if(!ensure_size(obj, *view)) return NULL;
+
+    return &(*view)->trace[trace];
+}
+
+static int32_t value_to_row(const wave_view_t * view, double value)
+{
+    double row = (view->range_max - value) * (view->height - 1) / (view->range_max - view->range_min);
+
+    if(!(row > 0)) return 0; // 含NaN
+    if(row > view->height - 1) return view->height - 1;
+    return (int32_t)(row + 0.5);
+}
+
+static void span_set(wave_trace * trace, int32_t column, int32_t top, int32_t bottom, wave_dirty * dirty)
+{
+    int16_t old_top    = trace->top[column];
+    int16_t old_bottom = trace->bottom[column];
+
+    if(old_top == top && (top == SPAN_EMPTY || old_bottom == bottom)) return;
+
+    if(!dirty->any) {
+        dirty->any = true;
+        dirty->x1  = column;
+        dirty->y1  = INT32_MAX;
+        dirty->y2  = INT32_MIN;
+    }
+    dirty->x2 = column;
+    if(old_top != SPAN_EMPTY) {
+        if(old_top < dirty->y1) dirty->y1 = old_top;
+        if(old_bottom > dirty->y2) dirty->y2 = old_bottom;
+    }
+    if(top != SPAN_EMPTY) {
+        if(top < dirty->y1) dirty->y1 = top;
+        if(bottom > dirty->y2) dirty->y2 = bottom;
+    }
+
+    trace->top[column]    = (int16_t)top;
+    trace->bottom[column] = (int16_t)bottom;
+}
+
+// 帧缓冲只重新合成变化的列, 整帧无效时无需记录
+static void frame_mark_stale(wave_view_t * view, int32_t x1, int32_t x2)
+{
+    if(!view->frame_valid) return;
+    if(!view->frame_stale) {
+        view->frame_stale = true;
+        view->stale_x1    = x1;
+        view->stale_x2    = x2;
+        return;
+    }
+    if(x1 < view->stale_x1) view->stale_x1 = x1;
+    if(x2 > view->stale_x2) view->stale_x2 = x2;
+}
+
+// 只让变化列的包围盒失效, 下次绘制时重新合成这些列
+static void dirty_commit(lv_obj_t * obj, wave_view_t * view, const wave_dirty * dirty)
+{
+    lv_area_t content;
+    lv_area_t area;
+
+    if(!dirty->any) return;
+    frame_mark_stale(view, dirty->x1, dirty->x2);
+
+    lv_obj_get_content_coords(obj, &content);
+    area.x1 = content.x1 + dirty->x1;
+    area.x2 = content.x1 + dirty->x2;
+    area.y1 = content.y1 + (dirty->y1 <= dirty->y2 ? dirty->y1 : 0);
+    area.y2 = content.y1 + (dirty->y1 <= dirty->y2 ? dirty->y2 + WAVE_VIEW_LINE_WIDTH - 1 : view->height - 1);
+    lv_obj_invalidate_area(obj, &area);
+}
+
+static int32_t grid_column(const wave_view_t * view, int i)
+{
+    return view->vdiv > 1 ? (view->width - 1) * i / (view->vdiv - 1) : 0;
+}
+
+// 边距取父对象背景色, 绘图区取控件背景色, 分隔线含四周边框
+static void build_grid(lv_obj_t * obj, wave_view_t * view)
+{
+    lv_obj_t * parent = lv_obj_get_parent(obj);
+    uint16_t margin   = lv_color_to_u16(parent != NULL ? lv_obj_get_style_bg_color(parent, LV_PART_MAIN)
+                                                       : lv_obj_get_style_bg_color(obj, LV_PART_MAIN));
+    uint16_t bg       = lv_color_to_u16(lv_obj_get_style_bg_color(obj, LV_PART_MAIN));
+    uint16_t line     = lv_color_to_u16(lv_palette_lighten(LV_PALETTE_GREY, 3));
+    uint16_t border   = lv_color_to_u16(lv_palette_lighten(LV_PALETTE_GREY, 1));
+    uint32_t stride   = view->background->header.stride;
+    int32_t w         = view->width;
+    int32_t h         = view->height;
+
+    for(int32_t y = 0; y < view->full_height; y++) {
+        uint16_t * row = (uint16_t *)(view->background->data + (size_t)y * stride);
+        bool in_plot   = y >= view->plot_y && y < view->plot_y + h;
+        for(int32_t x = 0; x < view->full_width; x++) {
+            row[x] = in_plot && x >= view->plot_x && x < view->plot_x + w ? bg : margin;
+        }
+    }
+
+#define PLOT_PX(x, y) ((uint16_t *)(view->background->data + (size_t)(view->plot_y + (y)) * stride))[view->plot_x + (x)]
+    for(int i = 0; i < view->hdiv; i++) {
+        int32_t y      = view->hdiv > 1 ? (h - 1) * i / (view->hdiv - 1) : 0;
+        uint16_t color = i == 0 || i == view->hdiv - 1 ? border : line;
+        for(int32_t x = 0; x < w; x++) PLOT_PX(x, y) = color;
+    }
+    for(int i = 0; i < view->vdiv; i++) {
+        int32_t x      = grid_column(view, i);
+        uint16_t color = i == 0 || i == view->vdiv - 1 ? border : line;
+        for(int32_t y = 0; y < h; y++) PLOT_PX(x, y) = color;
+    }
+#undef PLOT_PX
+}
+
+// 网格由本模块直接写像素, 文字等装饰经隐藏画布交给LVGL绘制, 只在尺寸、样式或装饰变化时执行
+static void background_rebuild_cb(void * data)
+{
+    lv_obj_t * obj     = data;
+    wave_view_t * view = lv_obj_get_user_data(obj);
+
+    // 重新分配缓冲区时不再重复排队, 本次即完成重建
+    bool ready               = ensure_size(obj, view);
+    view->background_pending = false;
+    if(!ready) return;
+
+    build_grid(obj, view);
+    if(view->decor_cb != NULL) {
+        lv_layer_t layer;
+        lv_area_t plot = {view->plot_x, view->plot_y, view->plot_x + view->width - 1,
+                          view->plot_y + view->height - 1};
+
+        if(view->canvas == NULL) {
+            view->canvas = lv_canvas_create(obj);
+            lv_obj_add_flag(view->canvas, LV_OBJ_FLAG_HIDDEN);
+        }
+        lv_canvas_set_draw_buf(view->canvas, view->background);
+        lv_canvas_init_layer(view->canvas, &layer);
+        view->decor_cb(obj, &layer, &plot, view->decor_user_data);
+        lv_canvas_finish_layer(view->canvas, &layer);
+
+        for(int i = 0; i < view->scratch_count; i++) {
+            lv_image_cache_drop(view->scratch[i]);
+            lv_draw_buf_destroy(view->scratch[i]);
+        }
+        view->scratch_count = 0;
+    }
+
+    lv_image_cache_drop(view->background);
+    view->background_valid = true;
+    view->frame_valid      = false;
+    lv_obj_invalidate(obj);
+}
+
+// 逐列填充各曲线区间, 写像素时不做混合
+static void render_spans(wave_view_t * view, int32_t x1, int32_t x2)
+{
+    uint32_t stride = view->frame->header.stride;
+    uint8_t * base  = view->frame->data + (size_t)view->plot_y * stride + view->plot_x * sizeof(uint16_t);
+
+    for(int i = 0; i < WAVE_VIEW_MAX_TRACES; i++) {
+        const wave_trace * trace = &view->trace[i];
+        if(!trace->used) continue;
+
+        for(int32_t c = x1; c <= x2; c++) {
+            int32_t top = trace->top[c];
+            if(top == SPAN_EMPTY) continue;
+
+            int32_t bottom = trace->bottom[c] + WAVE_VIEW_LINE_WIDTH - 1;
+            if(bottom >= view->height) bottom = view->height - 1;
+            uint8_t * px = base + (size_t)top * stride + c * sizeof(uint16_t);
+            for(int32_t y = top; y <= bottom; y++, px += stride) *(uint16_t *)px = trace->color;
+        }
+    }
+}
+
+// 只重新合成绘图区的x1..x2列: 逐行拷贝底图对应片段再填充区间
+static void render_columns(wave_view_t * view, int32_t x1, int32_t x2)
+{
+    uint32_t stride = view->frame->header.stride;
+    size_t offset   = (size_t)view->plot_y * stride + (view->plot_x + x1) * sizeof(uint16_t);
+    size_t bytes    = (size_t)(x2 - x1 + 1) * sizeof(uint16_t);
+
+    for(int32_t y = 0; y < view->height; y++, offset += stride) {
+        memcpy(view->frame->data + offset, view->background->data + offset, bytes);
+    }
+    render_spans(view, x1, x2);
+}
+
+// 拷贝整个底图后填充全部曲线
+static void render_frame(wave_view_t * view)
+{
+    // 两个缓冲区尺寸和格式相同, 行跨度一致
+    memcpy(view->frame->data, view->background->data, (size_t)view->frame->header.stride * view->full_height);
+    render_spans(view, 0, view->width - 1);
+
+    view->frame_valid = true;
+    view->frame_stale = false;
+}
+
+static void wave_view_event_cb(lv_event_t * e)
+{
+    lv_obj_t * obj     = lv_event_get_current_target_obj(e);
+    wave_view_t * view = lv_event_get_user_data(e);
+
+    switch(lv_event_get_code(e)) {
+        case LV_EVENT_DRAW_MAIN: {
+            lv_draw_image_dsc_t dsc;
+            lv_area_t area;
+
+            if(!ensure_size(obj, view) || !view->background_valid) return;
+            if(!view->frame_valid || view->frame_stale) {
+                if(!view->frame_valid) {
+                    render_frame(view);
+                } else {
+                    render_columns(view, view->stale_x1, view->stale_x2);
+                    view->frame_stale = false;
+                }
+                // 图片缓存以缓冲区地址为键, 内容变化后须丢弃旧条目
+                lv_image_cache_drop(view->frame);
+            }
+
+            lv_obj_get_coords(obj, &area);
+            lv_draw_image_dsc_init(&dsc);
+            dsc.src = view->frame;
+            lv_draw_image(lv_event_get_layer(e), &dsc, &area);
+            break;
+        }
+        case LV_EVENT_SIZE_CHANGED:
+        case LV_EVENT_STYLE_CHANGED: background_invalidate(obj, view); break;
+        case LV_EVENT_DELETE:
+            lv_async_call_cancel(background_rebuild_cb, obj);
+            for(int i = 0; i < view->scratch_count; i++) lv_draw_buf_destroy(view->scratch[i]);
+            free_buffers(view);
+            lv_free(view);
+            lv_obj_set_user_data(obj, NULL);
+            break;
+        default: break;
+    }
+}
+
+lv_obj_t * wave_view_create(lv_obj_t * parent)
+{
+    lv_obj_t * obj     = lv_obj_create(parent);
+    wave_view_t * view = lv_malloc_zeroed(sizeof(wave_view_t));
+
+    LV_ASSERT_MALLOC(view);
+    view->range_min = -1.0;
+    view->range_max = 1.0;
+    view->hdiv      = 3;
+    view->vdiv      = 5;
+
+    // 背景、边框都由底图绘制, 控件自身样式只提供颜色
+    lv_obj_set_user_data(obj, view);
+    lv_obj_remove_flag(obj, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_set_style_pad_all(obj, 0, LV_PART_MAIN);
+    lv_obj_set_style_radius(obj, 0, LV_PART_MAIN);
+    lv_obj_set_style_border_width(obj, 0, LV_PART_MAIN);
+    lv_obj_set_style_bg_opa(obj, LV_OPA_TRANSP, LV_PART_MAIN);
+    lv_obj_add_event_cb(obj, wave_view_event_cb, LV_EVENT_ALL, view);
+
+    return obj;
+}
+
+void wave_view_set_decor_cb(lv_obj_t * obj, wave_view_decor_cb_t decor_cb, void * user_data)
+{
+    wave_view_t * view = lv_obj_get_user_data(obj);
+
+    view->decor_cb        = decor_cb;
+    view->decor_user_data = user_data;
+    background_invalidate(obj, view);
+}
+
+void wave_view_invalidate_background(lv_obj_t * obj)
+{
+    background_invalidate(obj, lv_obj_get_user_data(obj));
+}
+
+// 文字先画到透明的临时缓冲, 再作为图片旋转绘制到底图; 临时缓冲在底图绘制完成后释放
+void wave_view_draw_label_vertical(lv_obj_t * obj, lv_layer_t * layer, const lv_draw_label_dsc_t * dsc,
+                                   const lv_point_t * center)
+{
+    wave_view_t * view = lv_obj_get_user_data(obj);
+    lv_point_t size;
+    lv_layer_t text_layer;
+    lv_draw_image_dsc_t image;
+
+    if(view->scratch_count >= WAVE_VIEW_MAX_SCRATCH) return;
+    lv_text_get_size(&size, dsc->text, dsc->font, dsc->letter_space, dsc->line_space, LV_COORD_MAX,
+                     LV_TEXT_FLAG_NONE);
+    if(size.x <= 0 || size.y <= 0) return;
+
+    lv_draw_buf_t * buf = lv_draw_buf_create(size.x, size.y, LV_COLOR_FORMAT_ARGB8888, LV_STRIDE_AUTO);
+    if(buf == NULL) return;
+    lv_draw_buf_clear(buf, NULL);
+    view->scratch[view->scratch_count++] = buf;
+
+    lv_obj_t * canvas = lv_canvas_create(obj);
+    lv_obj_add_flag(canvas, LV_OBJ_FLAG_HIDDEN);
+    lv_canvas_set_draw_buf(canvas, buf);
+    lv_canvas_init_layer(canvas, &text_layer);
+    lv_area_t area = {0, 0, size.x - 1, size.y - 1};
+    lv_draw_label(&text_layer, dsc, &area);
+    lv_canvas_finish_layer(canvas, &text_layer);
+    lv_obj_delete(canvas);
+
+    lv_draw_image_dsc_init(&image);
+    image.src      = buf;
+    image.rotation = 2700; // 逆时针90度, 自下而上阅读
+    image.pivot.x  = size.x / 2;
+    image.pivot.y  = size.y / 2;
+    area.x1        = center->x - size.x / 2;
+    area.y1        = center->y - size.y / 2;
+    area.x2        = area.x1 + size.x - 1;
+    area.y2        = area.y1 + size.y - 1;
+    lv_draw_image(layer, &image, &area);
+}
+
+void wave_view_set_range(lv_obj_t * obj, double min, double max)
+{
+    wave_view_t * view = lv_obj_get_user_data(obj);
+
+    if(max <= min) return;
+    view->range_min = min;
+    view->range_max = max;
+    lv_obj_invalidate(obj);
+}
+
+void wave_view_set_div_line_count(lv_obj_t * obj, uint8_t hdiv, uint8_t vdiv)
+{
+    wave_view_t * view = lv_obj_get_user_data(obj);
+
+    view->hdiv = hdiv;
+    view->vdiv = vdiv;
+    background_invalidate(obj, view);
+}
+
+int wave_view_add_trace(lv_obj_t * obj, lv_color_t color)
+{
+    wave_view_t * view = lv_obj_get_user_data(obj);
+
+    for(int i = 0; i < WAVE_VIEW_MAX_TRACES; i++) {
+        if(view->trace[i].used) continue;
+        view->trace[i].used  = true;
+        view->trace[i].color = lv_color_to_u16(color);
+        if(view->frame != NULL) {
+            for(int32_t c = 0; c < view->width; c++) view->trace[i].top[c] = SPAN_EMPTY;
+        }
+        return i;
+    }
+
+    return -1;
+}
+
+// 第c列覆盖采样位置[c*step, (c+1)*step], 区间取两端插值和其间所有采样的极值
+// 相邻列共用边界点, 折线连续; 每个采样只访问一次, 复杂度O(采样数+列数)
+void wave_view_set_samples(lv_obj_t * obj, int trace_id, const double * samples, uint32_t count)
+{
+    wave_view_t * view;
+    wave_trace * trace = trace_get(obj, trace_id, &view);
+    wave_dirty dirty   = {0};
+
+    if(trace == NULL) return;
+    if(count == 0) {
+        wave_view_clear(obj, trace_id);
+        return;
+    }
+
+    double step   = (double)(count - 1) / view->width;
+    double left   = samples[0];
+    uint32_t next = 1; // 下一个尚未计入的整数采样位置
+
+    for(int32_t c = 0; c < view->width; c++) {
+        double pos = step * (c + 1);
+        double lo  = left;
+        double hi  = left;
+
+        for(; next < count && next < pos; next++) {
+            if(samples[next] < lo) lo = samples[next];
+            if(samples[next] > hi) hi = samples[next];
+        }
+
+        uint32_t i   = (uint32_t)pos;
+        double right = i + 1 < count ? samples[i] + (samples[i + 1] - samples[i]) * (pos - i) : samples[count - 1];
+        if(right < lo) lo = right;
+        if(right > hi) hi = right;
+
+        span_set(trace, c, value_to_row(view, hi), value_to_row(view, lo), &dirty);
+        left = right;
+    }
+
+    dirty_commit(obj, view, &dirty);
+}
+
+// 包络按列合并, 列内无数据时留空; 与前一列不相交时向前一列延伸, 放大到一个采样跨多列时仍然连续
+// count个采样铺满从first起的columns列, first之前已有的区间作为前一列参与连接
+static void envelope_fill(wave_view_t * view, wave_trace * trace, int32_t first, int32_t columns, const double * min,
+                          const double * max, uint32_t count, wave_dirty * dirty)
+{
+    bool prev_valid     = first > 0 && trace->top[first - 1] != SPAN_EMPTY;
+    int32_t prev_top    = prev_valid ? trace->top[first - 1] : 0;
+    int32_t prev_bottom = prev_valid ? trace->bottom[first - 1] : 0;
+
+    for(int32_t k = 0; k < columns; k++) {
+        uint32_t a = (uint32_t)((uint64_t)k * count / columns);
+        uint32_t b = (uint32_t)((uint64_t)(k + 1) * count / columns);
+        double lo  = INFINITY;
+        double hi  = -INFINITY;
+
+        if(b <= a) b = a + 1;
+        for(uint32_t i = a; i < b; i++) {
+            if(min[i] < lo) lo = min[i]; // NaN比较为假, 自动跳过
+            if(max[i] > hi) hi = max[i];
+        }
+        if(lo > hi) {
+            span_set(trace, first + k, SPAN_EMPTY, 0, dirty);
+            prev_valid = false;
+            continue;
+        }
+
+        int32_t top         = value_to_row(view, hi);
+        int32_t bottom      = value_to_row(view, lo);
+        int32_t draw_top    = top;
+        int32_t draw_bottom = bottom;
+        if(prev_valid) {
+            if(draw_top > prev_bottom) draw_top = prev_bottom;
+            if(draw_bottom < prev_top) draw_bottom = prev_top;
+        }
+        span_set(trace, first + k, draw_top, draw_bottom, dirty);
+        prev_valid  = true;
+        prev_top    = top;
+        prev_bottom = bottom;
+    }
+}
+
+void wave_view_set_envelope(lv_obj_t * obj, int trace_id, const double * min, const double * max, uint32_t count)
+{
+    wave_view_t * view;
+    wave_trace * trace = trace_get(obj, trace_id, &view);
+    wave_dirty dirty   = {0};
+
+    if(trace == NULL) return;
+    if(count == 0) {
+        wave_view_clear(obj, trace_id);
+        return;
+    }
+
+    envelope_fill(view, trace, 0, view->width, min, max, count, &dirty);
+    dirty_commit(obj, view, &dirty);
+}
+
+void wave_view_set_envelope_tail(lv_obj_t * obj, int trace_id, const double * min, const double * max, uint32_t count,
+                                 uint32_t columns)
+{
+    wave_view_t * view;
+    wave_trace * trace = trace_get(obj, trace_id, &view);
+    wave_dirty dirty   = {0};
+
+    if(trace == NULL || count == 0 || columns == 0) return;
+    if(columns > (uint32_t)view->width) columns = view->width;
+
+    envelope_fill(view, trace, view->width - (int32_t)columns, (int32_t)columns, min, max, count, &dirty);
+    dirty_commit(obj, view, &dirty);
+}
+
+// 各曲线区间数组整体左移; 已合成的帧缓冲在绘图区内逐行左移, 只重新合成新露出的列和竖直分隔线所在的列
+// 绘图区内每个像素在屏幕上都换了位置, 只让新露出的列失效会留下未平移的旧画面, 所以整个绘图区都要失效
+void wave_view_scroll(lv_obj_t * obj, uint32_t columns)
+{
+    wave_view_t * view = lv_obj_get_user_data(obj);
+    lv_area_t content;
+
+    if(view == NULL || columns == 0 || !ensure_size(obj, view)) return;
+    if(columns > (uint32_t)view->width) columns = view->width;
+
+    int32_t shift = (int32_t)columns;
+    int32_t keep  = view->width - shift;
+    for(int i = 0; i < WAVE_VIEW_MAX_TRACES; i++) {
+        wave_trace * trace = &view->trace[i];
+        if(!trace->used) continue;
+        memmove(trace->top, trace->top + shift, keep * sizeof(int16_t));
+        memmove(trace->bottom, trace->bottom + shift, keep * sizeof(int16_t));
+        for(int32_t c = keep; c < view->width; c++) trace->top[c] = SPAN_EMPTY;
+    }
+
+    if(view->frame_valid && keep > 0) {
+        uint32_t stride = view->frame->header.stride;
+        uint8_t * row   = view->frame->data + (size_t)view->plot_y * stride + view->plot_x * sizeof(uint16_t);
+
+        for(int32_t y = 0; y < view->height; y++, row += stride) {
+            memmove(row, row + shift * sizeof(uint16_t), keep * sizeof(uint16_t));
+        }
+
+        // 待合成的列随内容一起左移
+        if(view->frame_stale) {
+            view->stale_x1 -= shift;
+            view->stale_x2 -= shift;
+            if(view->stale_x2 < 0) view->frame_stale = false;
+            if(view->stale_x1 < 0) view->stale_x1 = 0;
+        }
+
+        // 分隔线固定不动: 移出原位的和被移到别处的都要恢复
+        for(int i = 0; i < view->vdiv; i++) {
+            int32_t x = grid_column(view, i);
+            if(x < keep) render_columns(view, x, x);
+            if(x - shift >= 0) render_columns(view, x - shift, x - shift);
+        }
+        lv_image_cache_drop(view->frame);
+    }
+    frame_mark_stale(view, keep, view->width - 1);
+
+    lv_obj_get_content_coords(obj, &content);
+    lv_obj_invalidate_area(obj, &content);
+}
+
+void wave_view_clear(lv_obj_t * obj, int trace_id)
+{
+    wave_view_t * view;
+    wave_trace * trace = trace_get(obj, trace_id, &view);
+    wave_dirty dirty   = {0};
+
+    if(trace == NULL) return;
+    for(int32_t c = 0; c < view->width; c++) span_set(trace, c, SPAN_EMPTY, 0, &dirty);
+    dirty_commit(obj, view, &dirty);
+}
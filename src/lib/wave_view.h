@@ -0,0 +1,44 @@
+#ifndef WAVE_VIEW_H
+#define WAVE_VIEW_H
+
+#include <stdint.h>
+#include "lvgl/lvgl.h"
+
+// 流式波形控件: 代替lv_chart显示实时波形
+// 每条曲线按像素列归约为一段竖直区间, 绘制时在RGB565缓冲区里逐列填充, 不走通用折线和抗锯齿路径
+// 网格、刻度、标题、图例等静态内容预先渲染成底图, 每次重绘先整块拷贝底图, 再叠加各曲线, 最后作为一张图片交给LVGL输出
+// 底图覆盖整个控件, 内边距之内为绘图区, 之外留给坐标轴文字; 只在尺寸、样式或装饰变化时重建
+#define WAVE_VIEW_MAX_TRACES 16 // 与通道数上限一致
+#define WAVE_VIEW_LINE_WIDTH 2  // 曲线竖直方向加粗的像素数
+
+// 装饰回调, 在重建底图时调用, 坐标相对控件左上角, plot为绘图区
+typedef void (*wave_view_decor_cb_t)(lv_obj_t * obj, lv_layer_t * layer, const lv_area_t * plot, void * user_data);
+
+lv_obj_t * wave_view_create(lv_obj_t * parent);
+void wave_view_set_decor_cb(lv_obj_t * obj, wave_view_decor_cb_t decor_cb, void * user_data);
+// 装饰内容(如图例条目)变化后调用, 底图在下一轮定时器处理中重建
+void wave_view_invalidate_background(lv_obj_t * obj);
+// 只能在装饰回调中使用: 以center为中心绘制逆时针旋转90度的文字
+void wave_view_draw_label_vertical(lv_obj_t * obj, lv_layer_t * layer, const lv_draw_label_dsc_t * dsc,
+                                   const lv_point_t * center);
+// 纵轴显示范围(V), 超出范围的部分贴边显示
+void wave_view_set_range(lv_obj_t * obj, double min, double max);
+// 横向/纵向分隔线数, 含两端边框, 与lv_chart_set_div_line_count含义相同
+void wave_view_set_div_line_count(lv_obj_t * obj, uint8_t hdiv, uint8_t vdiv);
+// 返回曲线号, 后添加的曲线画在上层, 失败返回-1
+int wave_view_add_trace(lv_obj_t * obj, lv_color_t color);
+// 直接使用解码后的电压采样, count个采样铺满整个宽度, 少于像素列数时线性插值
+void wave_view_set_samples(lv_obj_t * obj, int trace, const double * samples, uint32_t count);
+// 逐点最小/最大包络(如历史视图、余辉), NaN表示无数据, 该位置不画
+void wave_view_set_envelope(lv_obj_t * obj, int trace, const double * min, const double * max, uint32_t count);
+void wave_view_clear(lv_obj_t * obj, int trace);
+// 滚动(roll)显示: 所有曲线整体左移columns列, 右侧露出的列为空, 再用set_envelope_tail填入新数据
+// 曲线区间和帧缓冲就地平移, 只对新露出的列做采样归约和区间填充
+// 但绘图区的像素在屏幕上全部移动, LVGL只能按区域失效, 没有硬件滚动,
+// 每次滚动仍要重绘并刷新整个绘图区, 这部分代价与绘图区面积成正比
+void wave_view_scroll(lv_obj_t * obj, uint32_t columns);
+// count个采样的包络铺满最右columns列, 与左侧已有区间相连; NaN表示无数据
+void wave_view_set_envelope_tail(lv_obj_t * obj, int trace, const double * min, const double * max, uint32_t count,
+                                 uint32_t columns);
+
+#endif // WAVE_VIEW_H
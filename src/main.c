@@ -8,22 +8,59 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <string.h>
-#include <linux/input.h>
-#include <sys/ioctl.h>
-#include <fcntl.h>
 #include "lib/linux_msg.h"
+#include "lib/ctrl_socket.h"
+#include "lib/frame_bus.h"
+#include "lib/spectrum.h"
+#include "lib/signal_stats.h"
+#include "lib/wave_history.h"
+#include "lib/decimate.h"
+#include "lib/scope.h"
+#include "lib/sp_ident.h"
+#include "lib/rfft.h"
+#include "lib/chart_dirty.h"
+#include "lib/wave_view.h"
+#include "lib/ui_post.h"
+#include "lib/driver_backends.h"
+#include "lib/backends.h"
+#include "lib/simulator_util.h"
+#include "lib/simulator_settings.h"
 
 #define PI 3.14159265358979323846
 #define REFRESH_TIME 100 // 刷新周期 ms
+#define UI_POST_PERIOD 5 // 执行其他线程投递的界面更新的周期 ms
+// 界面按产品屏幕分辨率布局, 窗口类后端默认使用该尺寸; 小于最小尺寸时图表被压扁、文字越界, 直接拒绝
+#define ANC_PANEL_WIDTH 1920
+#define ANC_PANEL_HEIGHT 1080
+#define ANC_MIN_WIDTH 1280
+#define ANC_MIN_HEIGHT 720
 #define CHART_WIDTH (LV_HOR_RES - 200)
 #define CHART_HEIGHT (LV_VER_RES - 350)
+#define CHART_GAP 90 // 波形图与频谱图间距, 容纳波形图X轴刻度和标题
+#define WAVE_CHART_HEIGHT ((CHART_HEIGHT - CHART_GAP) / 2)
+#define SPECTRUM_CHART_HEIGHT (CHART_HEIGHT - CHART_GAP - WAVE_CHART_HEIGHT)
+#define SPECTRUM_DB_SCALE 10 // 频谱图Y轴单位0.1dB
+#define SPECTRUM_X_LABELS 6
+#define HISTORY_MAX_COLUMNS 2048 // 历史视图最多列数, 每列输出最小/最大两个点
+#define HISTORY_MIN_SPAN 64      // 历史视图最小跨度(采样点)
+#define ROLL_SPAN_FRAMES 16      // 滚动显示整屏跨度(帧数)
+#define SP_FFT_SIZE 2048         // 辨识结果频响的FFT点数, 不小于SP_COEFF_MAX_TAPS
+#define SP_FFT_BINS (SP_FFT_SIZE / 2 + 1)
+#define SP_DB_RANGE 80           // 频响图动态范围(dB)
+#define SP_IMPULSE_FULL 1000     // 冲激响应按两组结果的峰值归一到该坐标值
 #define Y_SCALE 1024 // Y轴缩放因子（实际值放大1024倍处理浮点）
-
-const int16_t DISPLAY_DISPLAY_COUNT = 200; // 显示点个数
+#define WAVE_RANGE_V (10.0 * Y_SCALE / (Y_SCALE - 20)) // 波形图纵轴半幅(V), 与voltage_to_chart的缩放一致
+#define WAVE_BENCH_DEFAULT_FRAMES 300
+#define WAVE_AXIS_LEFT 90   // 波形控件左边距, 容纳纵轴刻度和标题
+#define WAVE_AXIS_BOTTOM 80 // 波形控件下边距, 容纳横轴刻度和标题, 不超过CHART_GAP
+#define LEGEND_WIDTH 200
+#define LEGEND_ROW_HEIGHT 30
+#define CHART_QUEUE_DEPTH (2 * SENSOR_MAX_CHANNELS) // 波形图只显示各通道最新帧
+
+const int16_t DISPLAY_DISPLAY_COUNT = 200; // 初始显示点个数, 运行中跟随帧长变化
 const int16_t CHART_BOTTOM_MARGIN   = 100;
 const int16_t GRID_X_COUNT          = 5; // X轴网格线数量
 const int16_t GRID_Y_COUNT          = 4; // Y轴网格线数量
-const uint16_t TOUCH_DEBOUNCE_MS    = 20;
 
 // 全局变量
 static lv_obj_t * chart;
@@ -31,32 +68,72 @@ static lv_obj_t * btn_container;
 static lv_obj_t * data_label;
 static lv_timer_t * chart_timer;
 static lv_timer_t * refresh_timer;
-static lv_chart_series_t * ref_signal_line;
-static lv_chart_series_t * err_signal_line;
+static int channel_trace[SENSOR_MAX_CHANNELS]; // 波形控件曲线号, 参考/误差通道初始化时创建, 其余首帧到达时创建, 未创建为-1
 static lv_display_t * disp;
-lv_obj_t * ref_label;
-lv_obj_t * err_label;
-
-extern bool has_new_ref_signal;
-extern bool has_new_err_signal;
-extern int32_t converted_ref_values[200];
-extern int32_t converted_err_values[200];
-extern double ref_max_val;
-extern double ref_min_val;
-extern double err_max_val;
-extern double err_min_val;
-
-typedef struct
-{
-    int fd;
-    int32_t min_x;
-    int32_t max_x;
-    int32_t min_y;
-    int32_t max_y;
-    bool calibrated;
-} TouchpadData;
-
-static TouchpadData touchpad = {.fd = -1, .min_x = 0, .max_x = 0, .min_y = 0, .max_y = 0, .calibrated = false};
+static lv_obj_t * spectrum_chart;
+static lv_chart_series_t * spectrum_series;
+static lv_obj_t * spectrum_x_labels[SPECTRUM_X_LABELS];
+static uint32_t spectrum_sample_rate; // 当前频率刻度对应的采样率, 0表示按频点序号标注
+
+// 帧总线订阅者, 均在UI线程中读取
+static frame_sub_t * chart_sub;
+static int32_t converted_values[FRAME_MAX_SAMPLES];          // lv_chart转换缓冲区, 仅基准测试的对照组使用
+static double decimated_values[FRAME_MAX_SAMPLES];           // 抽取结果, 点数不超过原始帧长
+static uint16_t chart_frame_samples = DISPLAY_DISPLAY_COUNT; // 最近一帧的采样数
+
+// 历史浏览: 拖动波形图进入, 左右平移, 上下缩放, 点Live返回实时显示
+static bool history_view;
+static uint64_t history_end;  // 视图右边界的绝对采样序号, 浏览时固定不随新数据移动
+static uint64_t history_span; // 视图跨度(采样点)
+static lv_obj_t * live_btn;
+static float history_min[HISTORY_MAX_COLUMNS];
+static float history_max[HISTORY_MAX_COLUMNS];
+static double history_lo[HISTORY_MAX_COLUMNS];
+static double history_hi[HISTORY_MAX_COLUMNS];
+
+// 滚动显示: 第k个绝对像素列对应采样[k*span/列数, (k+1)*span/列数), 每次只查询和归约新增的列
+static uint64_t roll_column; // 已画到的绝对列号(不含), 0表示需要整屏重画
+static uint64_t roll_span;   // 整屏跨度(采样点), 进入模式时按当前帧长确定
+
+// 示波器显示模式, 处理在scope线程中完成, UI只取结果
+static scope_config scope_cfg = {.mode           = SCOPE_MODE_RAW,
+                                 .record_samples = DISPLAY_DISPLAY_COUNT,
+                                 .average        = SCOPE_DEFAULT_AVERAGE,
+                                 .trigger_level  = 0.0};
+static scope_trace scope_result;
+static uint32_t scope_generation;
+static lv_obj_t * mode_label;
+static const char * const scope_mode_names[SCOPE_MODE_COUNT] = {"Raw", "Trigger", "Average", "Persist", "Roll"};
+
+// 次级通道辨识结果页: 当前结果与上一次结果叠加显示冲激响应和频响
+typedef enum { SP_ACTION_BACK, SP_ACTION_NEWER, SP_ACTION_OLDER, SP_ACTION_REQUEST } sp_action;
+// 主界面按钮, 作为事件user_data传入; 不比较标签文字, 标签带换行且可能调整
+typedef enum {
+    BTN_START_EXCITATION,
+    BTN_STOP_EXCITATION,
+    BTN_START_CONTROL,
+    BTN_STOP_CONTROL,
+    BTN_START_IDENTIFY,
+    BTN_STOP_IDENTIFY
+} ctrl_button;
+static lv_obj_t * main_screen;
+static lv_obj_t * sp_screen;
+static lv_obj_t * sp_impulse_chart;
+static lv_obj_t * sp_freq_chart;
+static lv_obj_t * sp_info_label;
+static lv_obj_t * sp_freq_label;
+static lv_chart_series_t * sp_impulse_series[2]; // [0]当前结果, [1]对比(更早一次)
+static lv_chart_series_t * sp_freq_series[2];
+static uint32_t sp_index; // 当前查看的缓存序号, 0为最新
+static uint32_t sp_generation;
+static sp_ident_result sp_results[2];
+static rfft_plan sp_plan;
+static float sp_fft_in[SP_FFT_SIZE];
+static float sp_fft_re[SP_FFT_BINS];
+static float sp_fft_im[SP_FFT_BINS];
+static double sp_curve[2][SP_FFT_BINS];
+static double sp_points[SP_FFT_BINS];
+static int32_t sp_values[SP_FFT_BINS];
 
 void get_sin_array(int16_t * array, size_t size, double frequency, double amplitude, double phase)
 {
@@ -66,327 +143,657 @@ void get_sin_array(int16_t * array, size_t size, double frequency, double amplit
     }
 }
 
+// 电压值转换为图表坐标
+static int32_t voltage_to_chart(double voltage)
+{
+    static const int scale = 1 * (Y_SCALE - 20);
+    return (int32_t)(voltage / 10.0 * scale);
+}
+
+// 帧长超过绘图区宽度时按像素列做M4抽取, 绘制点数受宽度约束, 返回输出点数
+static uint16_t convert_chart_values(const double * voltage, uint32_t count, uint32_t columns, int32_t * values)
+{
+    uint32_t points = decimate_m4(voltage, count, columns, decimated_values);
+
+    for(uint32_t i = 0; i < points; i++) values[i] = voltage_to_chart(decimated_values[i]);
+
+    return (uint16_t)points;
+}
+
+// 各通道曲线颜色, 参考/误差通道保持红/蓝
+static const lv_palette_t channel_palette[SENSOR_MAX_CHANNELS] = {
+    LV_PALETTE_RED,  LV_PALETTE_BLUE,   LV_PALETTE_GREEN,  LV_PALETTE_ORANGE, LV_PALETTE_PURPLE, LV_PALETTE_TEAL,
+    LV_PALETTE_PINK, LV_PALETTE_BROWN,  LV_PALETTE_CYAN,   LV_PALETTE_LIME,   LV_PALETTE_INDIGO, LV_PALETTE_AMBER,
+    LV_PALETTE_GREY, LV_PALETTE_YELLOW, LV_PALETTE_DEEP_ORANGE, LV_PALETTE_LIGHT_BLUE};
+
+// 新通道首帧到达时添加曲线, 图例在底图中, 重建一次底图
+static int channel_trace_get(uint16_t channel)
+{
+    if(channel_trace[channel] >= 0) return channel_trace[channel];
+
+    channel_trace[channel] = wave_view_add_trace(chart, lv_palette_main(channel_palette[channel]));
+    wave_view_invalidate_background(chart);
+
+    return channel_trace[channel];
+}
+
+// 已清空的曲线不再触发重绘
+static void chart_clear_series_from(int first_channel)
+{
+    for(int ch = first_channel; ch < SENSOR_MAX_CHANNELS; ch++) {
+        if(channel_trace[ch] >= 0) wave_view_clear(chart, channel_trace[ch]);
+    }
+}
+
+// 余辉模式画逐点包络, 其余模式与实时帧一样画单条曲线
+static void scope_render(void)
+{
+    if(!scope_read(&scope_result, &scope_generation) || scope_result.mode != scope_cfg.mode) return;
+
+    for(uint16_t ch = 0; ch < SCOPE_CHANNELS; ch++) {
+        if(scope_result.mode == SCOPE_MODE_PERSIST) {
+            wave_view_set_envelope(chart, channel_trace_get(ch), scope_result.env_min[ch], scope_result.env_max[ch],
+                                   scope_result.samples);
+        } else {
+            wave_view_set_samples(chart, channel_trace_get(ch), scope_result.value[ch], scope_result.samples);
+        }
+    }
+    chart_clear_series_from(SCOPE_CHANNELS);
+}
+
+// 新增列从波形历史按列取最小/最大值, 波形控件平移已有内容后只画这些列
+static void roll_render(void)
+{
+    uint32_t columns = (uint32_t)lv_obj_get_content_width(chart);
+    uint64_t latest  = wave_history_latest(SENSOR_CH_REF);
+    uint64_t err     = wave_history_latest(SENSOR_CH_ERR);
+
+    if(err < latest) latest = err; // 两通道都已写入的部分
+    if(columns == 0 || columns > HISTORY_MAX_COLUMNS || roll_span == 0) return;
+
+    uint64_t column = latest * columns / roll_span;
+    if(column <= roll_column) return;
+
+    // 首次进入或落后超过一屏时整屏重画
+    uint32_t fresh = column - roll_column < columns && roll_column != 0 ? (uint32_t)(column - roll_column) : columns;
+    uint64_t end   = column * roll_span / columns;
+    uint64_t span  = fresh == columns ? roll_span : end - (column - fresh) * roll_span / columns;
+
+    if(fresh < columns) wave_view_scroll(chart, fresh);
+    for(uint16_t ch = 0; ch < WAVE_HISTORY_CHANNELS; ch++) {
+        wave_history_render(ch, end, span, fresh, history_min, history_max);
+        for(uint32_t c = 0; c < fresh; c++) {
+            history_lo[c] = history_min[c];
+            history_hi[c] = history_max[c];
+        }
+        if(fresh < columns) {
+            wave_view_set_envelope_tail(chart, channel_trace_get(ch), history_lo, history_hi, fresh, fresh);
+        } else {
+            wave_view_set_envelope(chart, channel_trace_get(ch), history_lo, history_hi, fresh);
+        }
+    }
+    if(fresh == columns) chart_clear_series_from(WAVE_HISTORY_CHANNELS);
+    roll_column = column;
+}
+
 // 波形图更新函数
 // LVGL的定时器回调函数必须遵循预定义的类型签名void (*lv_timer_cb_t)(lv_timer_t *timer)，无论函数内部是否使用参数
 void update_chart(lv_timer_t * timer)
 {
+    frame_t * frame;
+    frame_t * latest[SENSOR_MAX_CHANNELS] = {NULL};
+
     (void)timer;
 
-    // 转换传感器数据
-    if(has_new_ref_signal == true) {
-        has_new_ref_signal = false;
-        lv_chart_set_series_values(chart, ref_signal_line, converted_ref_values, DISPLAY_DISPLAY_COUNT);
-        lv_chart_refresh(chart);
+    // 取空队列, 每个通道只保留最新一帧
+    while((frame = frame_sub_poll(chart_sub)) != NULL) {
+        frame_release(latest[frame->channel]);
+        latest[frame->channel] = frame;
+    }
+
+    // 浏览历史时视图固定, 示波器模式显示处理结果, 滚动模式从波形历史取数, 实时帧直接丢弃
+    if(history_view || scope_cfg.mode != SCOPE_MODE_RAW) {
+        for(int ch = 0; ch < SENSOR_MAX_CHANNELS; ch++) frame_release(latest[ch]);
+        if(history_view) return;
+        if(scope_cfg.mode == SCOPE_MODE_ROLL) {
+            roll_render();
+        } else {
+            scope_render();
+        }
+        return;
+    }
+
+    // 解码后的电压直接交给波形控件, 控件按像素列归约, 只让变化的列失效
+    for(int ch = 0; ch < SENSOR_MAX_CHANNELS; ch++) {
+        if(latest[ch] == NULL) continue;
+        chart_frame_samples = latest[ch]->count;
+        wave_view_set_samples(chart, channel_trace_get((uint16_t)ch), latest[ch]->voltage, latest[ch]->count);
+        frame_release(latest[ch]);
     }
+}
 
-    if(has_new_err_signal == true) {
-        has_new_err_signal = false;
+// 每个像素列画最小/最大区间, 尖峰不会因抽取丢失
+static void history_render(void)
+{
+    uint32_t columns = (uint32_t)lv_obj_get_content_width(chart);
+
+    if(columns > HISTORY_MAX_COLUMNS) columns = HISTORY_MAX_COLUMNS;
 
-        lv_chart_set_series_values(chart, err_signal_line, converted_err_values, DISPLAY_DISPLAY_COUNT);
-        lv_chart_refresh(chart);
+    for(uint16_t ch = 0; ch < WAVE_HISTORY_CHANNELS; ch++) {
+        wave_history_render(ch, history_end, history_span, columns, history_min, history_max);
+        for(uint32_t c = 0; c < columns; c++) {
+            history_lo[c] = history_min[c];
+            history_hi[c] = history_max[c];
+        }
+        wave_view_set_envelope(chart, channel_trace_get(ch), history_lo, history_hi, columns);
     }
+    chart_clear_series_from(WAVE_HISTORY_CHANNELS); // 其余通道不记录历史
 }
 
-// 显示坐标轴数据
-void create_axis_labels()
+static void chart_drag_cb(lv_event_t * e)
 {
-    static lv_color_t color_black;
+    uint64_t latest = wave_history_latest(SENSOR_CH_REF);
+    int32_t width   = lv_obj_get_content_width(chart);
+    lv_point_t vect;
 
-    color_black = lv_color_hex(0x000000); // 黑色
-    // 获取图表位置和尺寸
-    lv_area_t chart_area;
-    lv_obj_get_coords(chart, &chart_area);
-    printf("Chart area: x1=%d, y1=%d, x2=%d, y2=%d\n", chart_area.x1, chart_area.y1, chart_area.x2, chart_area.y2);
+    (void)e;
 
-    // 获取图表画布区域（排除边距）
-    lv_coord_t chart_width  = lv_area_get_width(&chart_area);
-    lv_coord_t chart_height = lv_area_get_height(&chart_area);
+    lv_indev_get_vect(lv_indev_active(), &vect);
+    if((vect.x == 0 && vect.y == 0) || width <= 0) return;
 
-    // 创建X轴标签
-    const char * x_labels[] = {"0", "40", "80", "120", "160", "200"};
-    for(int i = 0; i < 6; i++) {
-        lv_obj_t * label = lv_label_create(lv_scr_act());
-        lv_label_set_text(label, x_labels[i]);
-        // 计算X轴标签位置
-        lv_coord_t x_pos = chart_area.x1 + (chart_width * i / 5);
-        lv_coord_t y_pos = chart_area.y2 + 20;                        // 在图表下方20像素
-        lv_obj_set_pos(label, x_pos - 10, y_pos);                     // 调整微调位置
-        lv_obj_set_style_text_color(label, color_black, 0);           // 设置标签颜色
-        lv_obj_set_style_text_font(label, &lv_font_montserrat_20, 0); // 设置字体
+    if(!history_view) {
+        history_view = true;
+        history_end  = latest;
+        history_span = chart_frame_samples;
+        lv_obj_remove_flag(live_btn, LV_OBJ_FLAG_HIDDEN);
     }
 
-    // 创建Y轴标签
-    const char * y_labels[] = {"10", "5", "0", "-5", "-10"};
-    for(int i = 0; i < 5; i++) {
-        lv_obj_t * label = lv_label_create(lv_scr_act());
-        lv_label_set_text(label, y_labels[i]);
-        // 计算Y轴标签位置（从顶部开始计算）
-        lv_coord_t y_pos = chart_area.y1 + (chart_height * i / 4);
-        lv_obj_set_pos(label, chart_area.x1 - 30, y_pos - 10);        // 在图表左侧30像素
-        lv_obj_set_style_text_color(label, color_black, 0);           // 设置标签颜色
-        lv_obj_set_style_text_font(label, &lv_font_montserrat_20, 0); // 设置字体
+    // 上下拖动缩放, 向下每100像素跨度加倍
+    if(vect.y != 0) {
+        double span  = (double)history_span * pow(2.0, vect.y / 100.0);
+        history_span = span < HISTORY_MIN_SPAN     ? HISTORY_MIN_SPAN
+                       : span > WAVE_HISTORY_DEPTH ? WAVE_HISTORY_DEPTH
+                                                   : (uint64_t)span;
     }
 
-    // 添加轴标题
-    lv_obj_t * x_title = lv_label_create(lv_scr_act());
-    lv_label_set_text(x_title, "Time (ms)");
-    lv_obj_align_to(x_title, chart, LV_ALIGN_OUT_BOTTOM_MID, 0, 40);
-    lv_obj_set_style_text_color(x_title, color_black, 0);
-    lv_obj_set_style_text_font(x_title, &lv_font_montserrat_24, 0);
+    // 左右拖动平移, 向右拖看更早的数据, 移动量与当前跨度成比例
+    int64_t shift = (int64_t)vect.x * (int64_t)history_span / width;
+    if(shift > 0) {
+        history_end = history_end > history_span + (uint64_t)shift ? history_end - (uint64_t)shift : history_span;
+    } else {
+        history_end += (uint64_t)(-shift);
+    }
+    if(history_end > latest) history_end = latest;
 
-    lv_obj_t * y_title = lv_label_create(lv_scr_act());
-    lv_label_set_text(y_title, "Voltage (V)");
-    lv_obj_align_to(y_title, chart, LV_ALIGN_OUT_LEFT_MID, -20, 0);
-    lv_obj_set_style_text_color(y_title, color_black, 0);
-    lv_obj_set_style_transform_angle(y_title, -900, 0); // 旋转90度
-    lv_obj_set_style_text_font(y_title, &lv_font_montserrat_24, 0);
+    history_render();
 }
 
-void create_chart(void)
+static void live_btn_cb(lv_event_t * e)
+{
+    (void)e;
+
+    history_view = false;
+    roll_column  = 0;
+    lv_obj_add_flag(live_btn, LV_OBJ_FLAG_HIDDEN);
+}
+
+// 依次切换显示模式, 记录长度取当前帧长
+static void mode_btn_cb(lv_event_t * e)
+{
+    (void)e;
+
+    scope_cfg.mode           = (scope_mode)((scope_cfg.mode + 1) % SCOPE_MODE_COUNT);
+    scope_cfg.record_samples = chart_frame_samples;
+    scope_configure(&scope_cfg);
+    lv_label_set_text(mode_label, scope_mode_names[scope_cfg.mode]);
+    roll_column = 0;
+    roll_span   = (uint64_t)chart_frame_samples * ROLL_SPAN_FRAMES;
+}
+
+// 曲线按绘图宽度做M4抽取后画到图表, 同一图表的曲线长度相同, 抽取后点数一致
+static void sp_plot(lv_obj_t * target, lv_chart_series_t * series, const double * curve, uint32_t count,
+                    double offset, double scale)
+{
+    int32_t width   = lv_obj_get_content_width(target);
+    uint32_t points = decimate_m4(curve, count, width > 0 ? (uint32_t)width : 0, sp_points);
+
+    for(uint32_t i = 0; i < points; i++) sp_values[i] = (int32_t)((sp_points[i] - offset) * scale);
+    // 点数只随绘图宽度或系数长度变化, 不变时不重新分配序列缓冲区
+    if(points != lv_chart_get_point_count(target)) lv_chart_set_point_count(target, points);
+    lv_chart_set_series_values(target, series, sp_values, points);
+}
+
+// 幅频响应, 系数补零到SP_FFT_SIZE点
+static void sp_frequency_response(const sp_ident_result * result, double * db)
 {
-    // 创建图表对象
-    chart = lv_chart_create(lv_scr_act());
-    lv_obj_set_size(chart, CHART_WIDTH, CHART_HEIGHT);
-    lv_obj_align(chart, LV_ALIGN_BOTTOM_MID, 0, -CHART_BOTTOM_MARGIN);
-
-    // 设置图表类型为折线图,更新模式为CIRCULAR
-    lv_chart_set_type(chart, LV_CHART_TYPE_LINE);
-    lv_chart_set_update_mode(chart, LV_CHART_UPDATE_MODE_CIRCULAR);
-
-    // 设置网格线数量
-    lv_chart_set_div_line_count(chart, GRID_Y_COUNT + 1, GRID_X_COUNT + 1);
-    // 设置显示点数
-    lv_chart_set_point_count(chart, DISPLAY_DISPLAY_COUNT);
-
-    // 设置坐标轴轴范围
-    lv_chart_set_range(chart, LV_CHART_AXIS_PRIMARY_Y, -1.0 * Y_SCALE, 1.0 * Y_SCALE);
-    lv_chart_set_range(chart, LV_CHART_AXIS_PRIMARY_X, 0, DISPLAY_DISPLAY_COUNT);
-
-    // 添加数据系列（红色波形）
-    ref_signal_line = lv_chart_add_series(chart, lv_palette_main(LV_PALETTE_RED), LV_CHART_AXIS_PRIMARY_Y);
-    lv_chart_set_all_value(chart, ref_signal_line, 0);
-    // 添加数据系列（蓝色波形）
-    err_signal_line = lv_chart_add_series(chart, lv_palette_main(LV_PALETTE_BLUE), LV_CHART_AXIS_PRIMARY_Y);
-    lv_chart_set_all_value(chart, err_signal_line, 0);
-
-    // -------------------------- 手动创建图例（无legend组件适配） --------------------------
-    // 1. 创建图例容器（核心紧凑化配置）
-    lv_obj_t * legend_container = lv_obj_create(lv_scr_act());
-    lv_obj_set_size(legend_container, LV_SIZE_CONTENT, LV_SIZE_CONTENT); // 尺寸完全自适应内容（无多余空间）
-    lv_obj_set_flex_flow(legend_container, LV_FLEX_FLOW_COLUMN);         // 垂直排列
-
-    // 2. 容器样式（保持不变，或微调padding）
-    lv_obj_set_style_bg_color(legend_container, lv_color_white(), LV_STATE_DEFAULT);
-    lv_obj_set_style_bg_opa(legend_container, LV_OPA_70, LV_STATE_DEFAULT);
-    lv_obj_set_style_pad_all(legend_container, 0, LV_STATE_DEFAULT);    // 内边距设为0
-    lv_obj_set_style_border_side(legend_container, LV_BORDER_SIDE_NONE, LV_STATE_DEFAULT);
-    lv_obj_set_flex_align(legend_container, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_START);
-    lv_obj_align_to(legend_container, chart, LV_ALIGN_TOP_RIGHT, -220, 10);
-
-    // 3. 创建第一个条目：参考信号（红色）
-    lv_obj_t * ref_container = lv_obj_create(legend_container);
-    // 关键修改：不设置固定宽度（让flex自动分配），高度自适应内容
-    lv_obj_set_size(ref_container, LV_SIZE_CONTENT, 30);
-    lv_obj_set_flex_flow(ref_container, LV_FLEX_FLOW_ROW);
-    lv_obj_set_flex_align(ref_container, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
-    lv_obj_set_style_border_width(ref_container, 0, LV_STATE_DEFAULT);
-    lv_obj_set_style_border_side(ref_container, LV_BORDER_SIDE_NONE, LV_STATE_DEFAULT);
-    lv_obj_set_style_bg_opa(ref_container, LV_OPA_0, LV_STATE_DEFAULT); // 透明背景（替代移除所有样式）
-
-    // 3.1 颜色块（保持不变，或微调尺寸）
-    lv_obj_t * ref_color_block = lv_obj_create(ref_container);
-    lv_obj_set_size(ref_color_block, 50, 5);
-    lv_obj_set_style_bg_color(ref_color_block, lv_palette_main(LV_PALETTE_RED), LV_STATE_DEFAULT);
-    lv_obj_set_style_bg_opa(ref_color_block, LV_OPA_100, LV_STATE_DEFAULT);
-    lv_obj_set_style_radius(ref_color_block, 2, LV_STATE_DEFAULT);
-    lv_obj_set_style_margin_right(ref_color_block, 8, LV_STATE_DEFAULT); // 微调间距
-
-    // 3.2 文本标签（关键：使用默认字体测试，避免字体问题）
-    ref_label = lv_label_create(ref_container);
-    lv_label_set_text(ref_label, "Ref Signal"); // 简化文本，减少宽度占用
-    // 优先使用默认字体（确保显示），后续可换回自定义字体
-    lv_obj_set_style_text_font(ref_label, &lv_font_montserrat_22, LV_STATE_DEFAULT);
-    lv_obj_set_style_text_color(ref_label, lv_color_black(), LV_STATE_DEFAULT); // 明确文本颜色，避免透明
-
-    // 4. 创建第二个条目：误差信号（蓝色）
-    lv_obj_t * err_container = lv_obj_create(legend_container);
-    // 同第一个条目：宽度自适应，高度自适应
-    lv_obj_set_size(err_container, LV_SIZE_CONTENT, 30);
-    lv_obj_set_flex_flow(err_container, LV_FLEX_FLOW_ROW);
-    lv_obj_set_flex_align(err_container, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
-    lv_obj_set_style_border_width(err_container, 0, LV_STATE_DEFAULT);
-    lv_obj_set_style_border_side(err_container, LV_BORDER_SIDE_NONE, LV_STATE_DEFAULT);
-    lv_obj_set_style_bg_opa(err_container, LV_OPA_70, LV_STATE_DEFAULT);
-
-    // 4.1 颜色块（保持不变）
-    lv_obj_t * err_color_block = lv_obj_create(err_container);
-    lv_obj_set_size(err_color_block, 50, 5);
-    lv_obj_set_style_bg_color(err_color_block, lv_palette_main(LV_PALETTE_BLUE), LV_STATE_DEFAULT);
-    lv_obj_set_style_bg_opa(err_color_block, LV_OPA_100, LV_STATE_DEFAULT);
-    lv_obj_set_style_radius(err_color_block, 2, LV_STATE_DEFAULT);
-    lv_obj_set_style_margin_right(err_color_block, 8, LV_STATE_DEFAULT);
-
-    // 4.2 文本标签（同第一个条目，简化文本+默认字体）
-    err_label = lv_label_create(err_container);
-    lv_label_set_text(err_label, "Err Signal"); // 简化文本
-    lv_obj_set_style_text_font(err_label, &lv_font_montserrat_22, LV_STATE_DEFAULT);
-    lv_obj_set_style_text_color(err_label, lv_color_black(), LV_STATE_DEFAULT);
-    // --------------------------------------------------------------------------------
-
-    lv_obj_update_layout(chart);
-    // 创建刻度标签
-    create_axis_labels();
-}
-
-// 自动校准触摸屏范围
-bool touchpad_auto_calibrate(void)
-{
-    struct input_absinfo abs_info;
-
-    // 获取X轴范围
-    if(ioctl(touchpad.fd, EVIOCGABS(ABS_X), &abs_info) < 0) {
-        perror("Failed to get X range");
-        return false;
-    }
-    touchpad.min_x = abs_info.minimum;
-    touchpad.max_x = abs_info.maximum;
-
-    // 获取Y轴范围
-    if(ioctl(touchpad.fd, EVIOCGABS(ABS_Y), &abs_info) < 0) {
-        perror("Failed to get Y range");
-        return false;
-    }
-    touchpad.min_y = abs_info.minimum;
-    touchpad.max_y = abs_info.maximum;
-
-    touchpad.calibrated = true;
-    return true;
-}
-
-// 初始化触摸屏
-bool touchpad_init(void)
-{
-    touchpad.fd = open("/dev/input/touchscreen0", O_RDONLY | O_NONBLOCK);
-    if(touchpad.fd < 0) {
-        perror("Failed to open touchpad device");
-        return false;
-    }
-
-    // 尝试自动获取触摸屏范围
-    if(touchpad_auto_calibrate()) {
-        printf("Touchpad auto-calibrated: X(%d-%d), Y(%d-%d)\n", touchpad.min_x, touchpad.max_x, touchpad.min_y,
-               touchpad.max_y);
+    memset(sp_fft_in, 0, sizeof(sp_fft_in));
+    memcpy(sp_fft_in, result->coeff, result->taps * sizeof(float));
+    rfft_forward(&sp_plan, sp_fft_in, sp_fft_re, sp_fft_im);
+    for(int k = 0; k < SP_FFT_BINS; k++) {
+        double power = (double)sp_fft_re[k] * sp_fft_re[k] + (double)sp_fft_im[k] * sp_fft_im[k];
+        db[k]        = power > 1e-20 ? 10.0 * log10(power) : -200.0;
+    }
+}
+
+static void sp_view_render(void)
+{
+    uint32_t count = sp_ident_count(&sp_generation);
+    uint32_t taps  = 0;
+    double peak    = 0.0;
+    double top_db  = -200.0;
+    int curves     = 0;
+
+    lv_chart_set_all_value(sp_impulse_chart, sp_impulse_series[1], LV_CHART_POINT_NONE);
+    lv_chart_set_all_value(sp_freq_chart, sp_freq_series[1], LV_CHART_POINT_NONE);
+    if(count == 0) {
+        lv_label_set_text(sp_info_label, "No identification result yet");
+        lv_chart_set_all_value(sp_impulse_chart, sp_impulse_series[0], LV_CHART_POINT_NONE);
+        lv_chart_set_all_value(sp_freq_chart, sp_freq_series[0], LV_CHART_POINT_NONE);
+        return;
+    }
+    if(sp_index >= count) sp_index = count - 1;
+
+    for(int i = 0; i < 2 && sp_ident_get(sp_index + i, &sp_results[i]); i++) curves++;
+
+    // 冲激响应: 较短的结果补零到相同长度, 按两者共同的峰值归一
+    for(int i = 0; i < curves; i++) {
+        if(sp_results[i].taps > taps) taps = sp_results[i].taps;
+        for(uint16_t n = 0; n < sp_results[i].taps; n++) peak = fmax(peak, fabs(sp_results[i].coeff[n]));
+    }
+    if(peak <= 0.0) peak = 1.0;
+    for(int i = 0; i < curves; i++) {
+        for(uint32_t n = 0; n < taps; n++) sp_curve[i][n] = n < sp_results[i].taps ? sp_results[i].coeff[n] : 0.0;
+        sp_plot(sp_impulse_chart, sp_impulse_series[i], sp_curve[i], taps, 0.0, SP_IMPULSE_FULL / peak);
+    }
+
+    // 频响: 上限取最大值向上取整到10 dB
+    for(int i = 0; i < curves; i++) {
+        sp_frequency_response(&sp_results[i], sp_curve[i]);
+        for(int k = 0; k < SP_FFT_BINS; k++) top_db = fmax(top_db, sp_curve[i][k]);
+    }
+    top_db = ceil(top_db / 10.0) * 10.0;
+    lv_chart_set_range(sp_freq_chart, LV_CHART_AXIS_PRIMARY_Y, -SP_DB_RANGE * SPECTRUM_DB_SCALE, 0);
+    for(int i = 0; i < curves; i++) {
+        sp_plot(sp_freq_chart, sp_freq_series[i], sp_curve[i], SP_FFT_BINS, top_db, SPECTRUM_DB_SCALE);
+    }
+
+    if(curves > 1) {
+        lv_label_set_text_fmt(sp_info_label, "#%u (%u/%u): %u taps, peak %.4f   compare #%u: %u taps",
+                              sp_results[0].ident_id, sp_index + 1, count, sp_results[0].taps, peak,
+                              sp_results[1].ident_id, sp_results[1].taps);
     } else {
-        // 使用默认值（常见触摸屏范围）
-        touchpad.min_x      = 0;
-        touchpad.max_x      = 4095;
-        touchpad.min_y      = 0;
-        touchpad.max_y      = 4095;
-        touchpad.calibrated = false;
-        printf("Using default touchpad range: X(0-4095), Y(0-4095)\n");
+        lv_label_set_text_fmt(sp_info_label, "#%u (%u/%u): %u taps, peak %.4f", sp_results[0].ident_id,
+                              sp_index + 1, count, sp_results[0].taps, peak);
     }
+    lv_label_set_text_fmt(sp_freq_label, "0 - %u Hz, top %d dB, %d dB/div", sp_results[0].sample_rate / 2,
+                          (int)top_db, SP_DB_RANGE / GRID_Y_COUNT);
+    lv_chart_refresh(sp_impulse_chart);
+    lv_chart_refresh(sp_freq_chart);
+}
 
-    return true;
+static void sp_btn_cb(lv_event_t * e)
+{
+    switch((sp_action)(intptr_t)lv_event_get_user_data(e)) {
+        case SP_ACTION_BACK: lv_screen_load(main_screen); return;
+        case SP_ACTION_NEWER:
+            if(sp_index > 0) sp_index--;
+            break;
+        case SP_ACTION_OLDER: sp_index++; break;
+        case SP_ACTION_REQUEST: sp_ident_request(0); return;
+    }
+    sp_view_render();
 }
 
-// 输入设备回调函数
-void indev_callback(lv_indev_t * indev, lv_indev_data_t * data)
+static void sp_open_cb(lv_event_t * e)
 {
-    static int16_t last_x           = 0;
-    static int16_t last_y           = 0;
-    static bool touched             = false;
-    static uint32_t last_touch_time = 0;
+    (void)e;
 
-    struct input_event in;
+    sp_index = 0;
+    sp_view_render();
+    lv_screen_load(sp_screen);
+}
 
-    (void)indev;
+// 由接收线程投递到LVGL线程执行: 结果页可见时跳到最新结果, 多次投递只重绘一次
+static void sp_result_ui_cb(void * user_data)
+{
+    uint32_t generation;
 
-    if(touchpad.fd < 0 && !touchpad_init()) {
-        data->point.x = last_x;
-        data->point.y = last_y;
-        data->state   = touched ? LV_INDEV_STATE_PRESSED : LV_INDEV_STATE_RELEASED;
-        return;
+    (void)user_data;
+
+    if(lv_screen_active() != sp_screen) return;
+    sp_ident_count(&generation);
+    if(generation == sp_generation) return;
+    sp_index = 0;
+    sp_view_render();
+}
+
+// 在接收线程中调用, 只投递请求; 队列满时丢弃, 打开结果页时会重新读取缓存
+static void sp_result_notify(void)
+{
+    ui_post(sp_result_ui_cb, NULL);
+}
+
+static lv_obj_t * sp_create_chart(int32_t y, const char * title)
+{
+    lv_obj_t * target = lv_chart_create(sp_screen);
+    lv_obj_set_size(target, CHART_WIDTH, (LV_VER_RES - 320) / 2);
+    lv_obj_align(target, LV_ALIGN_TOP_MID, 0, y);
+    lv_chart_set_type(target, LV_CHART_TYPE_LINE);
+    lv_chart_set_div_line_count(target, GRID_Y_COUNT + 1, GRID_X_COUNT + 1);
+    lv_obj_set_style_size(target, 0, 0, LV_PART_INDICATOR);
+
+    lv_obj_t * label = lv_label_create(sp_screen);
+    lv_label_set_text(label, title);
+    lv_obj_align_to(label, target, LV_ALIGN_OUT_TOP_LEFT, 0, -5);
+    lv_obj_set_style_text_color(label, lv_color_black(), 0);
+    lv_obj_set_style_text_font(label, &lv_font_montserrat_22, 0);
+
+    return target;
+}
+
+static void sp_create_button(const char * text, sp_action action, int32_t x)
+{
+    lv_obj_t * btn = lv_btn_create(sp_screen);
+    lv_obj_set_size(btn, 160, 60);
+    lv_obj_align(btn, LV_ALIGN_TOP_LEFT, x, 10);
+    lv_obj_add_event_cb(btn, sp_btn_cb, LV_EVENT_CLICKED, (void *)(intptr_t)action);
+    lv_obj_t * label = lv_label_create(btn);
+    lv_label_set_text(label, text);
+    lv_obj_set_style_text_font(label, &lv_font_montserrat_22, 0);
+    lv_obj_center(label);
+}
+
+void create_sp_view(void)
+{
+    int32_t chart_height = (LV_VER_RES - 320) / 2;
+
+    if(rfft_init(&sp_plan, SP_FFT_SIZE) != 0) return;
+
+    main_screen = lv_scr_act();
+    sp_screen   = lv_obj_create(NULL);
+    lv_obj_set_style_bg_color(sp_screen, lv_color_white(), 0);
+
+    sp_create_button("Back", SP_ACTION_BACK, 100);
+    sp_create_button("Newer", SP_ACTION_NEWER, 280);
+    sp_create_button("Older", SP_ACTION_OLDER, 460);
+    sp_create_button("Fetch", SP_ACTION_REQUEST, 640);
+    sp_info_label = lv_label_create(sp_screen);
+    lv_obj_align(sp_info_label, LV_ALIGN_TOP_LEFT, 840, 28);
+    lv_obj_set_style_text_color(sp_info_label, lv_color_black(), 0);
+    lv_obj_set_style_text_font(sp_info_label, &lv_font_montserrat_22, 0);
+
+    sp_impulse_chart = sp_create_chart(140, "Impulse response (taps)");
+    lv_chart_set_range(sp_impulse_chart, LV_CHART_AXIS_PRIMARY_Y, -SP_IMPULSE_FULL * 11 / 10,
+                       SP_IMPULSE_FULL * 11 / 10);
+    sp_freq_chart = sp_create_chart(140 + chart_height + 80, "Magnitude response (dB)");
+    for(int i = 0; i < 2; i++) {
+        lv_color_t color     = i == 0 ? lv_palette_main(LV_PALETTE_BLUE) : lv_palette_main(LV_PALETTE_GREY);
+        sp_impulse_series[i] = lv_chart_add_series(sp_impulse_chart, color, LV_CHART_AXIS_PRIMARY_Y);
+        sp_freq_series[i]    = lv_chart_add_series(sp_freq_chart, color, LV_CHART_AXIS_PRIMARY_Y);
     }
 
-    // 读取所有事件
-    while(read(touchpad.fd, &in, sizeof(struct input_event)) > 0) {
-        if(in.type == EV_ABS) {
-            if(in.code == ABS_X) {
-                // 使用校准数据映射X坐标
-                if(touchpad.calibrated) {
-                    last_x = ((in.value - touchpad.min_x) * LV_HOR_RES) / (touchpad.max_x - touchpad.min_x);
-                } else {
-                    // 默认映射（假设常见范围）
-                    last_x = (in.value * LV_HOR_RES) / 4096;
-                }
+    sp_freq_label = lv_label_create(sp_screen);
+    lv_obj_align_to(sp_freq_label, sp_freq_chart, LV_ALIGN_OUT_BOTTOM_LEFT, 0, 10);
+    lv_obj_set_style_text_color(sp_freq_label, lv_color_black(), 0);
+    lv_obj_set_style_text_font(sp_freq_label, &lv_font_montserrat_20, 0);
+    lv_label_set_text(sp_freq_label, "");
+
+    // 主界面入口, 放在频谱图左上角
+    lv_obj_t * open_btn = lv_btn_create(main_screen);
+    lv_obj_set_size(open_btn, 160, 50);
+    lv_obj_align_to(open_btn, spectrum_chart, LV_ALIGN_TOP_LEFT, 10, 10);
+    lv_obj_add_event_cb(open_btn, sp_open_cb, LV_EVENT_CLICKED, NULL);
+    lv_obj_t * open_label = lv_label_create(open_btn);
+    lv_label_set_text(open_label, "SP result");
+    lv_obj_set_style_text_font(open_label, &lv_font_montserrat_22, 0);
+    lv_obj_center(open_label);
+}
 
-                // 边界检查
-                last_x = LV_CLAMP(0, last_x, LV_HOR_RES - 1);
-            } else if(in.code == ABS_Y) {
-                // 使用校准数据映射Y坐标
-                if(touchpad.calibrated) {
-                    last_y = ((in.value - touchpad.min_y) * LV_VER_RES) / (touchpad.max_y - touchpad.min_y);
-                } else {
-                    // 默认映射（假设常见范围）
-                    last_y = (in.value * LV_VER_RES) / 4096;
-                }
+// 波形图的刻度、轴标题和图例只绘制到波形控件的底图中, 曲线刷新时不再逐个重绘这些对象
+static void chart_decor_cb(lv_obj_t * obj, lv_layer_t * layer, const lv_area_t * plot, void * user_data)
+{
+    static const char * x_labels[] = {"0", "40", "80", "120", "160", "200"};
+    static const char * y_labels[] = {"10", "5", "0", "-5", "-10"};
+    int32_t plot_w                 = lv_area_get_width(plot);
+    int32_t plot_h                 = lv_area_get_height(plot);
+    lv_draw_label_dsc_t label;
+    lv_draw_rect_dsc_t rect;
+    lv_area_t area;
+    char text[16];
+
+    (void)user_data;
+
+    lv_draw_label_dsc_init(&label);
+    label.color = lv_color_black();
+    label.font  = &lv_font_montserrat_20;
+
+    // 横轴刻度居中于分隔线下方, 纵轴刻度右对齐到绘图区左侧
+    label.align = LV_TEXT_ALIGN_CENTER;
+    for(int i = 0; i <= GRID_X_COUNT; i++) {
+        int32_t x  = plot->x1 + plot_w * i / GRID_X_COUNT;
+        area       = (lv_area_t){x - 40, plot->y2 + 12, x + 40, plot->y2 + 36};
+        label.text = x_labels[i];
+        lv_draw_label(layer, &label, &area);
+    }
+    label.align = LV_TEXT_ALIGN_RIGHT;
+    for(int i = 0; i <= GRID_Y_COUNT; i++) {
+        int32_t y  = plot->y1 + plot_h * i / GRID_Y_COUNT;
+        area       = (lv_area_t){plot->x1 - 60, y - 11, plot->x1 - 8, y + 13};
+        label.text = y_labels[i];
+        lv_draw_label(layer, &label, &area);
+    }
 
-                // 边界检查
-                last_y = LV_CLAMP(0, last_y, LV_VER_RES - 1);
-            }
-        } else if(in.type == EV_KEY && in.code == BTN_TOUCH) {
-            // 应用消抖逻辑
-            bool raw_touched = (in.value != 0);
-            if(raw_touched != touched && lv_tick_elaps(last_touch_time) > TOUCH_DEBOUNCE_MS) {
-                touched         = raw_touched;
-                last_touch_time = lv_tick_get();
-            }
+    // 轴标题
+    label.font  = &lv_font_montserrat_24;
+    label.align = LV_TEXT_ALIGN_CENTER;
+    label.text  = "Time (ms)";
+    area        = (lv_area_t){plot->x1, plot->y2 + 44, plot->x2, plot->y2 + 72};
+    lv_draw_label(layer, &label, &area);
+    label.text        = "Voltage (V)";
+    lv_point_t center = {16, (plot->y1 + plot->y2) / 2};
+    wave_view_draw_label_vertical(obj, layer, &label, &center);
+
+    // 图例: 半透明底板, 每个已添加曲线的通道一行
+    int rows = 0;
+    for(int ch = 0; ch < SENSOR_MAX_CHANNELS; ch++) rows += channel_trace[ch] >= 0;
+    if(rows == 0) return;
+
+    lv_area_t legend = {plot->x2 - 220 - LEGEND_WIDTH, plot->y1 + 10, plot->x2 - 220,
+                        plot->y1 + 10 + rows * LEGEND_ROW_HEIGHT + 8};
+    lv_draw_rect_dsc_init(&rect);
+    rect.bg_color = lv_color_white();
+    rect.bg_opa   = LV_OPA_70;
+    rect.radius   = 4;
+    lv_draw_rect(layer, &rect, &legend);
+
+    label.font  = &lv_font_montserrat_22;
+    label.align = LV_TEXT_ALIGN_LEFT;
+    label.text  = text;
+    rect.bg_opa = LV_OPA_COVER;
+    rect.radius = 2;
+    int32_t y   = legend.y1 + 4;
+    for(int ch = 0; ch < SENSOR_MAX_CHANNELS; ch++) {
+        if(channel_trace[ch] < 0) continue;
+
+        rect.bg_color = lv_palette_main(channel_palette[ch]);
+        area          = (lv_area_t){legend.x1 + 8, y + 13, legend.x1 + 57, y + 17};
+        lv_draw_rect(layer, &rect, &area);
+
+        if(ch == SENSOR_CH_REF) {
+            snprintf(text, sizeof(text), "Ref Signal");
+        } else if(ch == SENSOR_CH_ERR) {
+            snprintf(text, sizeof(text), "Err Signal");
+        } else {
+            snprintf(text, sizeof(text), "Ch %d", ch);
+        }
+        area = (lv_area_t){legend.x1 + 66, y + 2, legend.x2 - 4, y + LEGEND_ROW_HEIGHT - 1};
+        lv_draw_label(layer, &label, &area);
+        y += LEGEND_ROW_HEIGHT;
+    }
+}
+
+void create_chart(void)
+{
+    // 创建波形控件, 实时数据量大, 不使用lv_chart
+    // 控件含坐标轴边距, 内边距之内的绘图区位置与尺寸保持CHART_WIDTH x WAVE_CHART_HEIGHT
+    chart = wave_view_create(lv_scr_act());
+    lv_obj_set_size(chart, CHART_WIDTH + WAVE_AXIS_LEFT, WAVE_CHART_HEIGHT + WAVE_AXIS_BOTTOM);
+    lv_obj_set_style_pad_left(chart, WAVE_AXIS_LEFT, LV_PART_MAIN);
+    lv_obj_set_style_pad_bottom(chart, WAVE_AXIS_BOTTOM, LV_PART_MAIN);
+    lv_obj_align(chart, LV_ALIGN_BOTTOM_MID, -WAVE_AXIS_LEFT / 2,
+                 -(CHART_BOTTOM_MARGIN + SPECTRUM_CHART_HEIGHT + CHART_GAP - WAVE_AXIS_BOTTOM));
+
+    // 设置网格线数量和纵轴范围
+    wave_view_set_div_line_count(chart, GRID_Y_COUNT + 1, GRID_X_COUNT + 1);
+    wave_view_set_range(chart, -WAVE_RANGE_V, WAVE_RANGE_V);
+
+    // 添加参考（红色）、误差（蓝色）波形, 其余通道首帧到达时添加
+    for(int ch = 0; ch < SENSOR_MAX_CHANNELS; ch++) channel_trace[ch] = -1;
+    channel_trace[SENSOR_CH_REF] = wave_view_add_trace(chart, lv_palette_main(channel_palette[SENSOR_CH_REF]));
+    channel_trace[SENSOR_CH_ERR] = wave_view_add_trace(chart, lv_palette_main(channel_palette[SENSOR_CH_ERR]));
+
+    // 拖动浏览历史, 控件本身不滚动
+    lv_obj_add_event_cb(chart, chart_drag_cb, LV_EVENT_PRESSING, NULL);
+
+    live_btn = lv_btn_create(lv_scr_act());
+    lv_obj_set_size(live_btn, 120, 50);
+    lv_obj_align_to(live_btn, chart, LV_ALIGN_TOP_LEFT, WAVE_AXIS_LEFT + 10, 10);
+    lv_obj_add_event_cb(live_btn, live_btn_cb, LV_EVENT_CLICKED, NULL);
+    lv_obj_add_flag(live_btn, LV_OBJ_FLAG_HIDDEN);
+    lv_obj_t * live_label = lv_label_create(live_btn);
+    lv_label_set_text(live_label, "Live");
+    lv_obj_set_style_text_font(live_label, &lv_font_montserrat_22, 0);
+    lv_obj_center(live_label);
+
+    lv_obj_t * mode_btn = lv_btn_create(lv_scr_act());
+    lv_obj_set_size(mode_btn, 140, 50);
+    lv_obj_align_to(mode_btn, chart, LV_ALIGN_TOP_LEFT, WAVE_AXIS_LEFT + 140, 10);
+    lv_obj_add_event_cb(mode_btn, mode_btn_cb, LV_EVENT_CLICKED, NULL);
+    mode_label = lv_label_create(mode_btn);
+    lv_label_set_text(mode_label, scope_mode_names[scope_cfg.mode]);
+    lv_obj_set_style_text_font(mode_label, &lv_font_montserrat_22, 0);
+    lv_obj_center(mode_label);
+
+    // 刻度、轴标题和图例绘制到底图
+    wave_view_set_decor_cb(chart, chart_decor_cb, NULL);
+}
+
+// 频率刻度: 采样率已知时标注Hz, 否则标注频点序号
+static void spectrum_update_x_labels(uint32_t sample_rate)
+{
+    for(int i = 0; i < SPECTRUM_X_LABELS; i++) {
+        uint32_t bin = (uint32_t)(SPECTRUM_BINS - 1) * i / (SPECTRUM_X_LABELS - 1);
+        if(sample_rate == 0) {
+            lv_label_set_text_fmt(spectrum_x_labels[i], "%u", (unsigned)bin);
+        } else {
+            lv_label_set_text_fmt(spectrum_x_labels[i], "%u",
+                                  (unsigned)((uint64_t)sample_rate * bin / SPECTRUM_FFT_SIZE));
         }
     }
-    // 更新LVGL数据
-    data->point.x = last_x;
-    data->point.y = last_y;
-    data->state   = touched ? LV_INDEV_STATE_PRESSED : LV_INDEV_STATE_RELEASED;
+    spectrum_sample_rate = sample_rate;
+}
+
+static void create_spectrum_chart(void)
+{
+    static const char * y_labels[] = {"0", "-30", "-60", "-90", "-120"};
+
+    spectrum_chart = lv_chart_create(lv_scr_act());
+    lv_obj_set_size(spectrum_chart, CHART_WIDTH, SPECTRUM_CHART_HEIGHT);
+    lv_obj_align(spectrum_chart, LV_ALIGN_BOTTOM_MID, 0, -CHART_BOTTOM_MARGIN);
+
+    lv_chart_set_type(spectrum_chart, LV_CHART_TYPE_LINE);
+    lv_chart_set_div_line_count(spectrum_chart, GRID_Y_COUNT + 1, GRID_X_COUNT + 1);
+    lv_chart_set_point_count(spectrum_chart, SPECTRUM_BINS);
+    lv_chart_set_range(spectrum_chart, LV_CHART_AXIS_PRIMARY_Y, (int32_t)(SPECTRUM_DB_FLOOR * SPECTRUM_DB_SCALE), 0);
+    lv_obj_set_style_size(spectrum_chart, 0, 0, LV_PART_INDICATOR); // 频点密集, 不画数据点
+    spectrum_series = lv_chart_add_series(spectrum_chart, lv_palette_main(channel_palette[SENSOR_CH_ERR]),
+                                          LV_CHART_AXIS_PRIMARY_Y);
+    lv_chart_set_all_value(spectrum_chart, spectrum_series, (int32_t)(SPECTRUM_DB_FLOOR * SPECTRUM_DB_SCALE));
+
+    lv_obj_update_layout(spectrum_chart);
+    lv_area_t area;
+    lv_obj_get_coords(spectrum_chart, &area);
+    lv_coord_t width  = lv_area_get_width(&area);
+    lv_coord_t height = lv_area_get_height(&area);
+
+    for(int i = 0; i < SPECTRUM_X_LABELS; i++) {
+        spectrum_x_labels[i] = lv_label_create(lv_scr_act());
+        lv_obj_set_pos(spectrum_x_labels[i], area.x1 + width * i / (SPECTRUM_X_LABELS - 1) - 10, area.y2 + 20);
+        lv_obj_set_style_text_color(spectrum_x_labels[i], lv_color_black(), 0);
+        lv_obj_set_style_text_font(spectrum_x_labels[i], &lv_font_montserrat_20, 0);
+    }
+    spectrum_update_x_labels(0);
+
+    for(int i = 0; i < 5; i++) {
+        lv_obj_t * label = lv_label_create(lv_scr_act());
+        lv_label_set_text(label, y_labels[i]);
+        lv_obj_set_pos(label, area.x1 - 45, area.y1 + height * i / 4 - 10);
+        lv_obj_set_style_text_color(label, lv_color_black(), 0);
+        lv_obj_set_style_text_font(label, &lv_font_montserrat_20, 0);
+    }
+
+    lv_obj_t * x_title = lv_label_create(lv_scr_act());
+    lv_label_set_text(x_title, "Frequency (Hz)");
+    lv_obj_align_to(x_title, spectrum_chart, LV_ALIGN_OUT_BOTTOM_MID, 0, 40);
+    lv_obj_set_style_text_color(x_title, lv_color_black(), 0);
+    lv_obj_set_style_text_font(x_title, &lv_font_montserrat_24, 0);
+
+    lv_obj_t * y_title = lv_label_create(lv_scr_act());
+    lv_label_set_text(y_title, "Err (dBV)");
+    lv_obj_align_to(y_title, spectrum_chart, LV_ALIGN_OUT_LEFT_MID, -30, 0);
+    lv_obj_set_style_text_color(y_title, lv_color_black(), 0);
+    lv_obj_set_style_transform_angle(y_title, -900, 0);
+    lv_obj_set_style_text_font(y_title, &lv_font_montserrat_24, 0);
 }
 
-// 初始化输入设备
-void input_evdev_init(void)
+// 频谱由分析线程计算, UI线程只在有新结果时拷贝一次并重绘
+static void spectrum_update_cb(lv_timer_t * timer)
 {
-    lv_indev_t * touch = lv_evdev_create(LV_INDEV_TYPE_POINTER, "/dev/input/touchscreen0");
-    lv_indev_set_display(touch, disp);
-    lv_indev_set_read_cb(touch, indev_callback);
+    static float db[SPECTRUM_BINS];
+    static int32_t values[SPECTRUM_BINS];
+    static uint32_t generation;
+    StreamConfig config;
+
+    (void)timer;
+
+    rpmsg_get_stream(&config);
+    if(config.sample_rate != spectrum_sample_rate) spectrum_update_x_labels(config.sample_rate);
+
+    if(!spectrum_read(db, &generation)) return;
+    for(int k = 0; k < SPECTRUM_BINS; k++) values[k] = (int32_t)(db[k] * SPECTRUM_DB_SCALE);
+    lv_chart_set_series_values(spectrum_chart, spectrum_series, values, SPECTRUM_BINS);
+    lv_chart_refresh(spectrum_chart);
 }
 
 // 按钮事件处理
 void btn_event_handler(lv_event_t * e)
 {
-    lv_obj_t * btn     = lv_event_get_target(e);
-    const char * label = lv_label_get_text(lv_obj_get_child(btn, 0));
-
-    if(strcmp(label, "Start excitation") == 0) {
-        if(chart_timer) {
-            lv_timer_resume(chart_timer);
-        } else {
-            chart_timer = lv_timer_create(update_chart, REFRESH_TIME, NULL);
-            if(chart_timer == NULL) {
-                printf("Error: Failed to create update timer\n");
-                return;
+    switch((ctrl_button)(intptr_t)lv_event_get_user_data(e)) {
+        case BTN_START_EXCITATION:
+            if(chart_timer) {
+                lv_timer_resume(chart_timer);
+            } else {
+                chart_timer = lv_timer_create(update_chart, REFRESH_TIME, NULL);
+                if(chart_timer == NULL) {
+                    printf("Error: Failed to create update timer\n");
+                    return;
+                }
             }
-        }
-        send_msg(CMD_START_EXCITATION, 0, 0);
-    } else if(strcmp(label, "Stop excitation") == 0) {
-        if(chart_timer) {
-            lv_timer_pause(chart_timer);
-        }
-        send_msg(CMD_STOP_EXCITATION, 0, 0);
-    } else if(strcmp(label, "Start control") == 0) {
-        send_msg(CMD_START_CONTROL, 0, 0);
-    } else if(strcmp(label, "Stop control") == 0) {
-        send_msg(CMD_STOP_CONTROL, 0, 0);
-    } else if(strcmp(label, "Start identify") == 0) {
-        send_msg(CMD_START_IDENTIFY, 0, 0);
-    } else if(strcmp(label, "Stop identify") == 0) {
-        send_msg(CMD_STOP_IDENTIFY, 0, 0);
+            send_msg(CMD_START_EXCITATION, 0, 0);
+            break;
+        case BTN_STOP_EXCITATION:
+            if(chart_timer) {
+                lv_timer_pause(chart_timer);
+            }
+            send_msg(CMD_STOP_EXCITATION, 0, 0);
+            break;
+        case BTN_START_CONTROL: send_msg(CMD_START_CONTROL, 0, 0); break;
+        case BTN_STOP_CONTROL: send_msg(CMD_STOP_CONTROL, 0, 0); break;
+        case BTN_START_IDENTIFY: send_msg(CMD_START_IDENTIFY, 0, 0); break;
+        case BTN_STOP_IDENTIFY:
+            send_msg(CMD_STOP_IDENTIFY, 0, 0);
+            sp_ident_request(0); // 取回本次辨识结果
+            break;
     }
 }
 
@@ -405,7 +812,8 @@ void create_button_ui(void)
     lv_obj_set_size(btn_start_excitation, 200, 120);
     lv_obj_set_style_bg_color(btn_start_excitation, lv_palette_lighten(LV_PALETTE_BLUE, 3), LV_STATE_DEFAULT);
     lv_obj_set_style_bg_opa(btn_start_excitation, LV_OPA_100, LV_STATE_DEFAULT);
-    lv_obj_add_event_cb(btn_start_excitation, btn_event_handler, LV_EVENT_CLICKED, NULL);
+    lv_obj_add_event_cb(btn_start_excitation, btn_event_handler, LV_EVENT_CLICKED,
+                        (void *)(intptr_t)BTN_START_EXCITATION);
     lv_obj_t * label_start_excitation = lv_label_create(btn_start_excitation);
     lv_label_set_text(label_start_excitation, "Start\nexcitation");                          // 设置文本
     lv_obj_set_style_text_font(label_start_excitation, &lv_font_montserrat_26, 0);           // 设置字体
@@ -419,7 +827,8 @@ void create_button_ui(void)
     lv_obj_set_size(btn_stop_excitation, 200, 120);
     lv_obj_set_style_bg_color(btn_stop_excitation, lv_palette_lighten(LV_PALETTE_BLUE, 3), LV_STATE_DEFAULT);
     lv_obj_set_style_bg_opa(btn_stop_excitation, LV_OPA_100, LV_STATE_DEFAULT);
-    lv_obj_add_event_cb(btn_stop_excitation, btn_event_handler, LV_EVENT_CLICKED, NULL);
+    lv_obj_add_event_cb(btn_stop_excitation, btn_event_handler, LV_EVENT_CLICKED,
+                        (void *)(intptr_t)BTN_STOP_EXCITATION);
     lv_obj_t * label_stop_excitation = lv_label_create(btn_stop_excitation);
     lv_label_set_text(label_stop_excitation, "Stop\nexcitation");
     lv_obj_set_style_text_font(label_stop_excitation, &lv_font_montserrat_26, 0);
@@ -429,7 +838,7 @@ void create_button_ui(void)
     // 开始控制按钮
     lv_obj_t * btn_start_control = lv_btn_create(btn_container);
     lv_obj_set_size(btn_start_control, 200, 120);
-    lv_obj_add_event_cb(btn_start_control, btn_event_handler, LV_EVENT_CLICKED, NULL);
+    lv_obj_add_event_cb(btn_start_control, btn_event_handler, LV_EVENT_CLICKED, (void *)(intptr_t)BTN_START_CONTROL);
     lv_obj_set_style_bg_color(btn_start_control, lv_palette_lighten(LV_PALETTE_BLUE, 3), LV_STATE_DEFAULT);
     lv_obj_set_style_bg_opa(btn_start_control, LV_OPA_100, LV_STATE_DEFAULT);
     lv_obj_t * label_start_control = lv_label_create(btn_start_control);
@@ -441,7 +850,7 @@ void create_button_ui(void)
     // 结束控制按钮
     lv_obj_t * btn_stop_control = lv_btn_create(btn_container);
     lv_obj_set_size(btn_stop_control, 200, 120);
-    lv_obj_add_event_cb(btn_stop_control, btn_event_handler, LV_EVENT_CLICKED, NULL);
+    lv_obj_add_event_cb(btn_stop_control, btn_event_handler, LV_EVENT_CLICKED, (void *)(intptr_t)BTN_STOP_CONTROL);
     lv_obj_set_style_bg_color(btn_stop_control, lv_palette_lighten(LV_PALETTE_BLUE, 3), LV_STATE_DEFAULT);
     lv_obj_set_style_bg_opa(btn_stop_control, LV_OPA_100, LV_STATE_DEFAULT);
     lv_obj_t * label_stop_control = lv_label_create(btn_stop_control);
@@ -453,7 +862,7 @@ void create_button_ui(void)
     // 开始辨识按钮
     lv_obj_t * btn_start_identify = lv_btn_create(btn_container);
     lv_obj_set_size(btn_start_identify, 200, 120);
-    lv_obj_add_event_cb(btn_start_identify, btn_event_handler, LV_EVENT_CLICKED, NULL);
+    lv_obj_add_event_cb(btn_start_identify, btn_event_handler, LV_EVENT_CLICKED, (void *)(intptr_t)BTN_START_IDENTIFY);
     lv_obj_set_style_bg_color(btn_start_identify, lv_palette_lighten(LV_PALETTE_BLUE, 3), LV_STATE_DEFAULT);
     lv_obj_set_style_bg_opa(btn_start_identify, LV_OPA_100, LV_STATE_DEFAULT);
     lv_obj_t * label_start_identify = lv_label_create(btn_start_identify);
@@ -465,7 +874,7 @@ void create_button_ui(void)
     // 结束辨识按钮
     lv_obj_t * btn_stop_identify = lv_btn_create(btn_container);
     lv_obj_set_size(btn_stop_identify, 200, 120);
-    lv_obj_add_event_cb(btn_stop_identify, btn_event_handler, LV_EVENT_CLICKED, NULL);
+    lv_obj_add_event_cb(btn_stop_identify, btn_event_handler, LV_EVENT_CLICKED, (void *)(intptr_t)BTN_STOP_IDENTIFY);
     lv_obj_set_style_bg_color(btn_stop_identify, lv_palette_lighten(LV_PALETTE_BLUE, 3), LV_STATE_DEFAULT);
     lv_obj_set_style_bg_opa(btn_stop_identify, LV_OPA_100, LV_STATE_DEFAULT);
     lv_obj_t * label_stop_identify = lv_label_create(btn_stop_identify);
@@ -475,15 +884,18 @@ void create_button_ui(void)
     lv_obj_center(label_stop_identify);
 }
 
+// 统计由统计线程按滑动窗口计算, 这里只取最新快照显示
 static void data_refresh_cb(lv_timer_t * timer)
 {
+    signal_stats_snapshot stats;
+
     (void)timer;
-    lv_label_set_text_fmt(data_label, "Ref Signal: Max=%8.5f,\t Min=%8.5f\t   Err Signal: Max=%8.5f,\t Min=%8.5f",
-                          ref_max_val, ref_min_val, err_max_val, err_min_val);
-    ref_max_val = -10.0;
-    ref_min_val = 10.0;
-    err_max_val = -10.0;
-    err_min_val = 10.0;
+    if(!signal_stats_read(&stats)) return;
+    lv_label_set_text_fmt(data_label,
+                          "Ref: RMS=%7.4f Peak=%7.4f Crest=%5.2f   Err: RMS=%7.4f Peak=%7.4f Crest=%5.2f   "
+                          "Atten=%6.1f dB",
+                          stats.ref.rms, stats.ref.peak, stats.ref.crest, stats.err.rms, stats.err.peak,
+                          stats.err.crest, stats.attenuation_db);
 }
 
 void create_data_ui(void)
@@ -505,44 +917,339 @@ void create_data_ui(void)
     lv_obj_set_style_pad_all(data_label, 8, LV_STATE_DEFAULT);        // 内边距8px
 
     // 4. 初始显示文本
-    lv_label_set_text_fmt(data_label, "Ref Signal: Max=%8.5f,\t Min=%8.5f\t\t\t\t\tErr Signal: Max=%8.5f,\t Min=%8.5f",
-                          0.0, 0.0, 0.0, 0.0);
+    lv_label_set_text_fmt(data_label,
+                          "Ref: RMS=%7.4f Peak=%7.4f Crest=%5.2f   Err: RMS=%7.4f Peak=%7.4f Crest=%5.2f   "
+                          "Atten=%6.1f dB",
+                          0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0);
+}
+
+// 波形绘制基准测试: 相同尺寸和数据下比较lv_chart(原create_chart配置, M4抽取+局部失效)与wave_view,
+// 以及wave_view滚动显示(每帧平移并补画1/ROLL_SPAN_FRAMES屏)
+// 每帧计时分为写入数据和lv_refr_now渲染输出两段, 渲染段包含刷新到显示设备
+typedef enum { WAVE_BENCH_CHART, WAVE_BENCH_VIEW, WAVE_BENCH_ROLL } wave_bench_kind;
+
+typedef struct
+{
+    uint64_t update_us;
+    uint64_t render_us;
+    uint64_t worst_us;
+} wave_bench_result;
+
+static double bench_samples[2][FRAME_MAX_SAMPLES];
+
+// 两通道正弦叠加高频分量, 每帧相位推进, 保证每帧所有列都有变化
+static void wave_bench_frame(uint32_t n, uint32_t count)
+{
+    for(int ch = 0; ch < 2; ch++) {
+        for(uint32_t i = 0; i < count; i++) {
+            double t             = (double)i / count;
+            bench_samples[ch][i] = (6.0 - 3.0 * ch) * sin(2 * PI * (3 + ch) * t + 0.1 * n) +
+                                   0.5 * sin(2 * PI * 97 * t + 0.7 * n);
+        }
+    }
 }
 
-int main(void)
+static void wave_bench_run(lv_obj_t * target, wave_bench_kind kind, uint32_t frames, wave_bench_result * result)
 {
+    lv_chart_series_t * series[2];
+    chart_dirty dirty;
+    int trace[2];
+    uint32_t columns = (uint32_t)lv_obj_get_content_width(target);
+
+    if(kind == WAVE_BENCH_CHART) {
+        chart_dirty_init(&dirty, target, -1 * Y_SCALE, 1 * Y_SCALE);
+        for(int ch = 0; ch < 2; ch++) {
+            series[ch] = lv_chart_add_series(target, lv_palette_main(channel_palette[ch]), LV_CHART_AXIS_PRIMARY_Y);
+            lv_chart_set_all_value(target, series[ch], 0);
+        }
+    } else {
+        for(int ch = 0; ch < 2; ch++) trace[ch] = wave_view_add_trace(target, lv_palette_main(channel_palette[ch]));
+    }
+    // 先渲染一帧, 让wave_view分配缓冲区并排队重建底图, 再处理一次定时器完成重建
+    lv_refr_now(disp);
+    lv_timer_handler();
+    lv_refr_now(disp);
+
+    memset(result, 0, sizeof(*result));
+    for(uint32_t n = 0; n < frames; n++) {
+        wave_bench_frame(n, FRAME_MAX_SAMPLES);
+
+        uint64_t start = rpmsg_now_us();
+        if(kind == WAVE_BENCH_CHART) {
+            chart_dirty_begin(&dirty);
+            for(int ch = 0; ch < 2; ch++) {
+                uint16_t points = convert_chart_values(bench_samples[ch], FRAME_MAX_SAMPLES, columns, converted_values);
+                if(points != lv_chart_get_point_count(target)) {
+                    lv_chart_set_point_count(target, points);
+                    lv_chart_set_range(target, LV_CHART_AXIS_PRIMARY_X, 0, points);
+                }
+                chart_dirty_set_series(&dirty, series[ch], converted_values, points);
+            }
+            chart_dirty_commit(&dirty);
+        } else if(kind == WAVE_BENCH_ROLL) {
+            wave_view_scroll(target, columns / ROLL_SPAN_FRAMES);
+            for(int ch = 0; ch < 2; ch++) {
+                wave_view_set_envelope_tail(target, trace[ch], bench_samples[ch], bench_samples[ch], FRAME_MAX_SAMPLES,
+                                            columns / ROLL_SPAN_FRAMES);
+            }
+        } else {
+            for(int ch = 0; ch < 2; ch++) {
+                wave_view_set_samples(target, trace[ch], bench_samples[ch], FRAME_MAX_SAMPLES);
+            }
+        }
+        uint64_t updated = rpmsg_now_us();
+        lv_refr_now(disp);
+        uint64_t done = rpmsg_now_us();
+
+        result->update_us += updated - start;
+        result->render_us += done - updated;
+        if(done - start > result->worst_us) result->worst_us = done - start;
+    }
+}
+
+static void wave_bench_print(const char * name, const wave_bench_result * result, uint32_t frames)
+{
+    printf("%-10s update %7.3f ms  render %7.3f ms  total %7.3f ms  worst %7.3f ms\n", name,
+           result->update_us / 1000.0 / frames, result->render_us / 1000.0 / frames,
+           (result->update_us + result->render_us) / 1000.0 / frames, result->worst_us / 1000.0);
+}
+
+static void run_wave_benchmark(uint32_t frames)
+{
+    wave_bench_result chart_result;
+    wave_bench_result view_result;
+    wave_bench_result roll_result;
+    lv_obj_t * screen = lv_obj_create(NULL);
+
+    if(frames == 0) frames = WAVE_BENCH_DEFAULT_FRAMES;
+    lv_screen_load(screen);
+
+    // 对照组: 与改用wave_view之前的create_chart相同的lv_chart配置
+    lv_obj_t * target = lv_chart_create(screen);
+    lv_obj_set_size(target, CHART_WIDTH, WAVE_CHART_HEIGHT);
+    lv_obj_center(target);
+    lv_obj_remove_flag(target, LV_OBJ_FLAG_SCROLLABLE);
+    lv_chart_set_type(target, LV_CHART_TYPE_LINE);
+    lv_chart_set_update_mode(target, LV_CHART_UPDATE_MODE_CIRCULAR);
+    lv_chart_set_div_line_count(target, GRID_Y_COUNT + 1, GRID_X_COUNT + 1);
+    lv_chart_set_point_count(target, DISPLAY_DISPLAY_COUNT);
+    lv_chart_set_range(target, LV_CHART_AXIS_PRIMARY_Y, -1.0 * Y_SCALE, 1.0 * Y_SCALE);
+    lv_obj_update_layout(target);
+    wave_bench_run(target, WAVE_BENCH_CHART, frames, &chart_result);
+    lv_obj_delete(target);
+
+    target = wave_view_create(screen);
+    lv_obj_set_size(target, CHART_WIDTH, WAVE_CHART_HEIGHT);
+    lv_obj_center(target);
+    wave_view_set_div_line_count(target, GRID_Y_COUNT + 1, GRID_X_COUNT + 1);
+    wave_view_set_range(target, -WAVE_RANGE_V, WAVE_RANGE_V);
+    lv_obj_update_layout(target);
+    wave_bench_run(target, WAVE_BENCH_VIEW, frames, &view_result);
+    wave_bench_run(target, WAVE_BENCH_ROLL, frames, &roll_result);
+    lv_obj_delete(target);
+
+    printf("Waveform benchmark: %u frames, %d x %d, %u samples x 2 channels\n", frames, (int)CHART_WIDTH,
+           (int)WAVE_CHART_HEIGHT, (unsigned)FRAME_MAX_SAMPLES);
+    wave_bench_print("lv_chart", &chart_result, frames);
+    wave_bench_print("wave_view", &view_result, frames);
+    wave_bench_print("roll", &roll_result, frames);
+}
+
+// 整屏基准测试: 创建主界面全部控件, 每帧写入合成波形和频谱并让整屏失效, 统计lv_refr_now耗时
+// 绘制单元数在编译时确定, 用scripts/draw_unit_bench.sh分别以1/2/4个绘制线程编译运行比较
+static void run_ui_benchmark(uint32_t frames)
+{
+    static int32_t spectrum_values[SPECTRUM_BINS];
+    wave_bench_result result;
+
+    if(frames == 0) frames = WAVE_BENCH_DEFAULT_FRAMES;
+
+    create_button_ui();
+    create_chart();
+    create_spectrum_chart();
+    create_data_ui();
+    lv_refr_now(disp);
+    lv_timer_handler();
+    lv_refr_now(disp);
+
+    memset(&result, 0, sizeof(result));
+#if LV_USE_LINUX_FBDEV
+    backend_vblank_t vblank_start;
+    backend_vblank_t vblank_end;
+    bool flips = backend_fbdev_get_vblank(&vblank_start) == 0;
+#endif
+    for(uint32_t n = 0; n < frames; n++) {
+        wave_bench_frame(n, FRAME_MAX_SAMPLES);
+        for(int k = 0; k < SPECTRUM_BINS; k++) {
+            double db          = -60.0 + 20.0 * sin(0.05 * k + 0.1 * n) - 30.0 * k / SPECTRUM_BINS;
+            spectrum_values[k] = (int32_t)(db * SPECTRUM_DB_SCALE);
+        }
+
+        uint64_t start = rpmsg_now_us();
+        for(uint16_t ch = 0; ch < 2; ch++) {
+            wave_view_set_samples(chart, channel_trace_get(ch), bench_samples[ch], FRAME_MAX_SAMPLES);
+        }
+        lv_chart_set_series_values(spectrum_chart, spectrum_series, spectrum_values, SPECTRUM_BINS);
+        lv_obj_invalidate(lv_screen_active());
+        uint64_t updated = rpmsg_now_us();
+        lv_refr_now(disp);
+        uint64_t done = rpmsg_now_us();
+
+        result.update_us += updated - start;
+        result.render_us += done - updated;
+        if(done - start > result.worst_us) result.worst_us = done - start;
+    }
+
+    printf("UI benchmark: %u frames, %d x %d, %d draw unit(s)\n", frames, LV_HOR_RES, LV_VER_RES,
+           LV_DRAW_SW_DRAW_UNIT_CNT);
+    wave_bench_print("screen", &result, frames);
+
+    // fbdev翻页模式下统计实际显示的帧, 绘制快于刷新率时每帧间隔被vsync限制
+#if LV_USE_LINUX_FBDEV
+    if(flips && backend_fbdev_get_vblank(&vblank_end) == 0 && vblank_end.frames - vblank_start.frames > 1) {
+        uint32_t presented = vblank_end.frames - vblank_start.frames;
+        printf("UI benchmark: %u frames presented, %.1f us per flip\n", presented,
+               (double)(vblank_end.timestamp_us - vblank_start.timestamp_us) / presented);
+    }
+#endif
+}
+
+extern simulator_settings_t settings; // driver_backends.c
+
+// 命令行参数, 与sample.c一致
+static void print_usage(void)
+{
+    fprintf(stdout, "\nlvglsim [-B] [-b backend_name] [-W window_width] [-H window_height]\n\n");
+    fprintf(stdout, "-B list supported backends\n");
+}
+
+// 返回-b选择的显示后端, 未指定时为NULL(默认后端)
+static char * configure_backend(int argc, char ** argv)
+{
+    char * backend = NULL;
+    int opt;
+
+    driver_backends_register();
+
+    const char * env_w     = getenv("LV_SIM_WINDOW_WIDTH");
+    const char * env_h     = getenv("LV_SIM_WINDOW_HEIGHT");
+    settings.window_width  = env_w ? atoi(env_w) : ANC_PANEL_WIDTH;
+    settings.window_height = env_h ? atoi(env_h) : ANC_PANEL_HEIGHT;
+
+    while((opt = getopt(argc, argv, "b:W:H:Bh")) != -1) {
+        switch(opt) {
+            case 'h': print_usage(); exit(EXIT_SUCCESS);
+            case 'B': driver_backends_print_supported(); exit(EXIT_SUCCESS);
+            case 'b':
+                if(driver_backends_is_supported(optarg) == 0) die("error no such backend: %s\n", optarg);
+                backend = optarg;
+                break;
+            case 'W': settings.window_width = atoi(optarg); break;
+            case 'H': settings.window_height = atoi(optarg); break;
+            default: print_usage(); exit(EXIT_FAILURE);
+        }
+    }
+    return backend;
+}
+
+// 其他线程投递的界面更新在LVGL定时器中执行, 各后端的运行循环都能驱动
+static void ui_post_timer_cb(lv_timer_t * timer)
+{
+    (void)timer;
+    ui_post_drain();
+}
+
+int main(int argc, char ** argv)
+{
+    char * backend = configure_backend(argc, argv);
+
     // 初始化LVGL
     lv_init();
+    ui_post_init();
 
-    disp = lv_linux_fbdev_create();
-    lv_linux_fbdev_set_file(disp, "/dev/fb0");
+    if(frame_bus_init() != 0) return 0;
+    chart_sub = frame_bus_subscribe(FRAME_MASK_ALL, CHART_QUEUE_DEPTH, FRAME_DROP_OLDEST);
+    if(chart_sub == NULL || signal_stats_start() != 0 || wave_history_start() != 0 ||
+       scope_start() != 0)
+        return 0;
+
+    // 显示后端由-b选择, 默认FBDEV; DRM在两个扫描缓冲区间直接渲染并原子翻页, 无拷贝、无撕裂
+    if(driver_backends_init_backend(backend) == -1) die("Failed to initialize display backend\n");
+    disp = lv_display_get_default();
+    if(disp == NULL) die("Failed to initialize display backend\n");
+    int32_t hor_res = lv_display_get_horizontal_resolution(disp);
+    int32_t ver_res = lv_display_get_vertical_resolution(disp);
+    if(hor_res < ANC_MIN_WIDTH || ver_res < ANC_MIN_HEIGHT)
+        die("Display %dx%d is smaller than the %dx%d the layout needs\n", (int)hor_res, (int)ver_res, ANC_MIN_WIDTH,
+            ANC_MIN_HEIGHT);
+
+    // ANC_WAVE_BENCH=帧数时只运行波形绘制基准测试, 0取默认帧数
+    const char * bench_frames = getenv("ANC_WAVE_BENCH");
+    if(bench_frames != NULL) {
+        run_wave_benchmark((uint32_t)strtoul(bench_frames, NULL, 10));
+        return 0;
+    }
+    // ANC_UI_BENCH=帧数时只运行整屏绘制基准测试
+    bench_frames = getenv("ANC_UI_BENCH");
+    if(bench_frames != NULL) {
+        run_ui_benchmark((uint32_t)strtoul(bench_frames, NULL, 10));
+        return 0;
+    }
+
+    // X11、Wayland、GLFW创建显示时已带输入设备; SDL用鼠标, FBDEV、DRM的触摸屏经EVDEV后端自动发现, OFFSCREEN无输入
+#if LV_USE_SDL
+    if(backend != NULL && strcmp(backend, "SDL") == 0) lv_sdl_mouse_create();
+#endif
+#if LV_USE_EVDEV
+    bool headless = backend != NULL && strcmp(backend, "OFFSCREEN") == 0;
+    if(!headless && lv_indev_get_next(NULL) == NULL && driver_backends_init_backend("EVDEV") == -1)
+        printf("Error: Failed to initialize evdev\n");
+#endif
 
     // 创建按键UI界面
     create_button_ui();
-    input_evdev_init();
 
     // 创建波形图
     create_chart();
     chart_timer = lv_timer_create(update_chart, REFRESH_TIME, NULL);
     lv_timer_enable(chart_timer); // 启动定时器
 
+    // 创建误差信号频谱图
+    create_spectrum_chart();
+    if(spectrum_start(SENSOR_CH_ERR) == 0) {
+        lv_timer_create(spectrum_update_cb, REFRESH_TIME, NULL);
+    } else {
+        printf("Error: Failed to start spectrum analyzer\n");
+    }
+
+    // 创建次级通道辨识结果页
+    create_sp_view();
+
     // 创建数据显示区域
     create_data_ui();
-    refresh_timer = lv_timer_create(data_refresh_cb, 1000, NULL);
+    refresh_timer = lv_timer_create(data_refresh_cb, 500, NULL);
     lv_timer_enable(refresh_timer); // 启动刷新定时器
 
     printf("UI created successfully.\n");
     printf("LV_HOR_RES=%d, LV_VER_RES =%d\n", LV_HOR_RES, LV_VER_RES);
 
+    // 本地控制socket, 路径可由环境变量ANC_CTRL_SOCKET覆盖
+    const char * ctrl_path = getenv("ANC_CTRL_SOCKET");
+    bool ctrl_ok           = ctrl_socket_start(ctrl_path ? ctrl_path : CTRL_SOCKET_PATH) == 0;
+
+    sp_ident_set_notify(sp_result_notify);
+    if(sp_ident_start() != 0) printf("Error: Failed to start identification receiver\n");
     if(start_rpmsg() != EXIT_SUCCESS) {
         printf("start_rpmsg failed!\n");
-        return 0;
+        if(!ctrl_ok) return 0;
+        // 无实时核时由测试客户端经控制socket注入数据
+        printf("Running without real-time core, frames only via ctrl socket\n");
     }
 
-    // 主循环
-    while(1) {
-        lv_timer_handler();
-        usleep(500);
-    }
+    // 进入所选后端的运行循环
+    // LVGL对象只在本线程访问; 绘制线程由LVGL在lv_timer_handler内部加锁调度,
+    // 其他线程(RPMsg、控制socket、分析线程)通过帧总线和各模块的互斥量交换数据, 需要更新界面时经ui_post投递到本线程的定时器执行
+    lv_timer_create(ui_post_timer_cb, UI_POST_PERIOD, NULL);
+    driver_backends_run_loop();
     return 0;
 }
\ No newline at end of file